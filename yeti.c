@@ -15,7 +15,25 @@
 #include <termios.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <limits.h>
 #include <time.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <signal.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sched.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /***MACROS***/
 
@@ -25,19 +43,109 @@
 // macro to check if any ctrl+key combination was used 
 #define CTRL_KEY(k) ((k) & 0x1f)
 
+// flags added to a special key when it was pressed with shift, alt or ctrl
+#define KEY_SHIFT (1 << 16)
+#define KEY_ALT (1 << 17)
+#define KEY_CTRL (1 << 18)
+#define KEY_MODS (KEY_SHIFT | KEY_ALT | KEY_CTRL)
+
+// size of the ring buffer the keys are read into, a power of two
+#define YETI_INPUT_SIZE 4096
+
+// no. of keys held back while a long edit runs, the ones typed after that are dropped
+#define YETI_HELD_KEYS 256
+
+// ms a long edit runs for between looks at the keys, short enough for the screen to keep up
+#define YETI_WORK_SLICE_MS 10
+
+// max length of an escape sequence, anything longer is taken as plain bytes
+#define YETI_ESC_MAX 32
+
+// no. of lines scrolled by one step of the mouse wheel
+#define YETI_WHEEL_LINES 3
+
+// no. of slots of the timer wheel and the ms each slot covers
+#define YETI_TIMER_SLOTS 64
+#define YETI_TIMER_TICK_MS 100
+
+// ms a status message stays on the screen and ms between saves of the session
+#define YETI_MESSAGE_MS 5000
+#define YETI_AUTOSAVE_MS 30000
+
 // defines one tab space
 #define YETI_TAB_STOP 8
 
+// no. of rows below which line commands do not bother spawning threads
+#define YETI_PARALLEL_MIN_ROWS 65536
+
+// upper limit on the no. of threads spawned for a parallel pass
+#define YETI_MAX_THREADS 16
+
+// no. of finished tasks each worker can hand back before the main loop takes them
+#define YETI_RING_SIZE 1024
+
+// no. of iovecs handed to a single writev() call
+#define YETI_IOV_BATCH 1024
+
+// size of the chunks read from a pipe
+#define YETI_PIPE_CHUNK 65536
+
+// max no. of edits the diff searches for before it shows the changed lines as a replacement
+#define YETI_DIFF_MAX_EDITS 2048
+
+// no. of unchanged lines shown around the changes of a diff
+#define YETI_DIFF_CONTEXT 3
+
+// no. of bytes shown on each line of the hex view
+#define YETI_HEX_WIDTH 16
+
+// max no. of entries kept in a prompt history
+#define YETI_HISTORY_MAX 100
+
+// max no. of jobs running in the background and no. of chunks read from a job before the keys are looked at again
+#define YETI_JOBS_MAX 8
+#define YETI_JOB_READS 16
+
+// ms a cancelled command gets to exit after SIGTERM before it is sent SIGKILL, and ms between looks at the cancelled commands that were not collected yet
+#define YETI_JOB_KILL_MS 1000
+#define YETI_REAP_MS 100
+
+// no. of named marks (a to z) of a buffer and max no. of positions kept in the jump list
+#define YETI_MARKS 26
+#define YETI_JUMPS_MAX 100
+
+// hashes standing in for the rows before the first and after the last one when hashing the buffer
+#define YETI_HASH_FIRST 0x243F6A8885A308D3ULL
+#define YETI_HASH_LAST 0x13198A2E03707344ULL
+
+// magic and version at the start of a session file
+#define YETI_SESSION_MAGIC "YSES"
+#define YETI_SESSION_VERSION 1
+
 /***DATA***/
 
+// struct to hold the text of a row as it was when a version was taken, never changed once made and freed with the last row or version holding it
+struct editorLine{
+	int refs; // no. of rows and versions holding the line, only changed with atomic builtins
+	int len; // length of the text
+	unsigned long long hash; // hash of the text
+	char text[]; // the text
+};
+
 // struct to  store the text typed
 typedef struct editorRow{
 	int size; // stores the length of the text
 	int rsize; // stores the size of the actual text to be rendered
 	char* text; // holds a line of text
 	char* render; // contains the actual text to be rendered
+	unsigned long long hash; // hash of the text, kept up to date by editorUpdateRow
+	unsigned int id; // given when the row is made and kept while it is edited or moved, marks find their row by it
+	struct editorLine* line; // text of the row shared with the versions taken since it last changed, NULL till a version is taken
 } erow;
 
+// id given to the last row made
+unsigned int lastrowid = 0;
+
 // enum to represent the non- printable keys
 enum editorKey{
 	BACKSPACE = 127,
@@ -49,13 +157,59 @@ enum editorKey{
 	PAGE_DOWN,
 	DEL_KEY,
 	HOME_KEY,
-	END_KEY
+	END_KEY,
+	INSERT_KEY,
+	F1_KEY, F2_KEY, F3_KEY, F4_KEY, F5_KEY, F6_KEY, F7_KEY, F8_KEY, F9_KEY, F10_KEY, F11_KEY, F12_KEY,
+	MOUSE_EVENT, // the details are in mouse
+	JOB_EVENT, // a job in the background is done
+	WORK_EVENT, // a long edit is due its next slice
+	WORK_CANCEL, // escape was pressed while a long edit ran
+	UNKNOWN_KEY // an escape sequence that is not bound to anything
+};
+
+// struct to hold the last mouse event reported by the terminal
+struct editorMouse{
+	int button; // button no. with the motion (32) and wheel (64) bits as sent by the terminal
+	int x, y; // screen column and row counted from 0
+	int pressed; // 0 when the button was released
+} mouse;
+
+// the whole file transforms that can be run over a range of rows
+enum editorTransform{
+	TRANSFORM_TRIM, // remove trailing whitespace
+	TRANSFORM_EXPAND, // turn every tab into spaces
+	TRANSFORM_UNEXPAND // turn the leading whitespace into tabs followed by the spaces left over
+};
+
+// the compression formats a file can be stored in, they index the codecs table
+enum editorCompression{
+	COMPRESS_NONE,
+	COMPRESS_GZIP,
+	COMPRESS_ZSTD
+};
+
+// struct to describe a compression format, it is recognised by its magic bytes and handled by running its command line tool
+struct editorCodec{
+	const char* name; // name shown to the user
+	const char* magic; // bytes the compressed data starts with
+	int magiclen; // no. of magic bytes
+	char* decompress[4]; // command writing the decompressed stdin to stdout
+	char* compress[4]; // command writing the compressed stdin to stdout
+};
+
+// the codecs in the order of enum editorCompression
+struct editorCodec codecs[] = {
+	{"none", NULL, 0, {NULL}, {NULL}},
+	{"gzip", "\x1f\x8b", 2, {"gzip", "-dc", NULL}, {"gzip", "-c", NULL}},
+	{"zstd", "\x28\xb5\x2f\xfd", 4, {"zstd", "-dcq", NULL}, {"zstd", "-cq", NULL}}
 };
 
 // struct to store the original attributes of the terminal to help configure  the editor size
 struct editorConfig{
 	int linenooff; // tells us the size of the line no col
 	int modified; // tells us whether the text loaded and the text in the current state are same
+	int edits; // no. of edits since the file was loaded or saved, undo states are taken every few of them
+	unsigned long long hash; // hash of the whole text built from the hashes of its rows and their neighbours
 	char* filename; // stores the filename of the current file open in the editor
 	int cx, cy; // stores the position of the cursor
 	int rx; // holds cursor coordinate for the actual render
@@ -65,14 +219,65 @@ struct editorConfig{
 	int textrows; // store the no. of rows that contain the  text
 	erow* row; // a pointer in which each item holds one line of text and its length
 	int screencols; // stores the width of the terminal
-	char statusmsg[80]; // stores status message
-	time_t statusmsg_time; //holds timestamp to the set status message
+	char statusmsg[80]; // stores status message, cleared by its timer
 	struct termios orig; // stores the attributes of the original terminal
+	enum editorCompression compress; // format the file is stored in, the text is recompressed on save
 };
 
 // state variables that holds the current state of the editor
 struct editorConfig state;
 
+// set when a script is run with --batch, the editor then never touches the terminal
+int batchmode = 0;
+
+// struct to hold a file shown by the pager, it is drawn straight from a private mapping and never split into rows
+struct editorPager{
+	char* map; // contents of the file
+	size_t size; // size of the file
+	size_t top; // offset of the first line shown
+	int coloff; // leftmost column shown
+	char* filename; // name of the file
+	char* query; // last search, NULL if none
+	size_t qlen; // length of the last search, hex searches may hold nul bytes
+	size_t match; // offset of the last match, -1 if none
+	int hex; // set when the file is shown as offset, hex and ascii columns and can be overwritten
+	int fd; // descriptor the changed pages are written back to, -1 if the file is read only
+	size_t cursor; // offset of the byte under the cursor in the hex view
+	int nibble; // set when the cursor is on the low nibble of the byte
+	unsigned char* dirty; // one bit per page of the mapping that was overwritten
+	int dirtypages; // no. of bits set in dirty
+} pager;
+
+// set when the editor runs as a pager with -R
+int pagermode = 0;
+
+// struct to hold the previous inputs of a prompt, oldest first
+struct editorHistory{
+	char** items; // the inputs
+	int size; // no. of inputs
+};
+
+// searches typed at the search prompt, saved with the session
+struct editorHistory searchhist = {NULL, 0};
+
+// commands typed at the command prompt, saved with the session
+struct editorHistory cmdhist = {NULL, 0};
+
+// no. of prompts open, the output of jobs is only used when there is none
+int prompting = 0;
+
+// struct to hold the options that can be switched with the set command
+struct editorOptions{
+	int autoindent; // new lines start with the indentation of the line they were split from
+	int trimonsave; // trailing whitespace is removed before saving
+	int expandonsave; // tabs are expanded to spaces before saving
+	int unexpandonsave; // leading spaces are turned into tabs before saving
+	int esctimeout; // ms to wait for the rest of an escape sequence before a lone escape is taken as the escape key
+};
+
+// current values of the options
+struct editorOptions opts = {1, 0, 0, 0, 50};
+
 // stuct to store the previous and next states of the text and also a func to clone the state
 typedef struct undoRedo{
 	struct editorConfig* states; // stores the states from when the file was svaed to disk
@@ -81,8 +286,21 @@ typedef struct undoRedo{
 	struct editorConfig* (*clone)(); // funtion pointer that will hold the func to clone the state
 } undoRedo;
 
-// function to clone erow struct
-erow* cloneErow(const erow* src, int num_rows) {
+// func to get the line holding the text of a row, made from the text if the row has none since it last changed
+struct editorLine* editorRowLine(erow* row){
+	if(row->line == NULL){
+		row->line = malloc(sizeof(struct editorLine) + row->size + 1);
+		row->line->refs = 1;
+		row->line->len = row->size;
+		row->line->hash = row->hash;
+		memcpy(row->line->text, row->text, row->size);
+		row->line->text[row->size] = '\0';
+	}
+	return row->line;
+}
+
+// function to clone erow struct, the clone is a row of an undo state whose text is the shared line of the row and which has no render
+erow* cloneErow(erow* src, int num_rows) {
 	erow* dst = (erow*)malloc(num_rows * sizeof(erow));
     	if (dst == NULL) {
         	fprintf(stderr, "Memory allocation failed\n");
@@ -91,20 +309,20 @@ erow* cloneErow(const erow* src, int num_rows) {
 
     	for (int i = 0; i < num_rows; i++) {
         	dst[i].size = src[i].size;
-        	dst[i].rsize = src[i].rsize;
-        	dst[i].text = strdup(src[i].text);
-        	dst[i].render = strdup(src[i].render);
-        	if (dst[i].text == NULL || dst[i].render == NULL) {
-            		fprintf(stderr, "Memory allocation failed\n");
-            		exit(EXIT_FAILURE);
-        	}
+        	dst[i].rsize = 0;
+        	dst[i].hash = src[i].hash;
+        	dst[i].id = src[i].id;
+        	dst[i].line = editorRowLine(&src[i]);
+        	__atomic_add_fetch(&dst[i].line->refs, 1, __ATOMIC_RELAXED);
+        	dst[i].text = dst[i].line->text;
+        	dst[i].render = NULL;
     	}
 	
     	return dst;
 }
 
 // function to clone the state wwhich is assigned to the undoRedo struct
-struct editorConfig* cloneState(const struct editorConfig* src) {
+struct editorConfig* cloneState(struct editorConfig* src) {
     	struct editorConfig* dst = (struct editorConfig*)malloc(sizeof(struct editorConfig));
     	if (dst == NULL) {
         	fprintf(stderr, "Memory allocation failed\n");
@@ -113,18 +331,20 @@ struct editorConfig* cloneState(const struct editorConfig* src) {
     
     	dst->linenooff = src->linenooff;
     	dst->modified = src->modified;
+    	dst->edits = src->edits;
+    	dst->hash = src->hash;
     	dst->filename = (src->filename) ? strdup(src->filename) : NULL;
     	dst->cx = src->cx;
     	dst->cy = src->cy;
     	dst->rx = src->rx;
     	dst->rowoff = src->rowoff;
     	dst->coloff = src->coloff;
+    	dst->compress = src->compress;
     	dst->screenrows = src->screenrows;
     	dst->textrows = src->textrows;
     	dst->row = (src->row) ? cloneErow(src->row, src->textrows) : NULL;
     	dst->screencols = src->screencols;
     	strcpy(dst->statusmsg, src->statusmsg);
-    	dst->statusmsg_time = src->statusmsg_time;
     	memcpy(&dst->orig, &src->orig, sizeof(struct termios));
     
     	return dst;
@@ -132,6 +352,112 @@ struct editorConfig* cloneState(const struct editorConfig* src) {
 
 undoRedo ur; // stores the undoRedo information
 
+// struct to hold a position that follows its row when rows are inserted, deleted or moved above it, edits never touch it and the row is only looked up when the mark is used
+struct editorMark{
+	int buf; // index of the buffer
+	unsigned int id; // id of the row, 0 if the mark is not set
+	int line; // index the row was last seen at, the lookup starts there and the mark falls back to it once the row is gone
+	int col; // column in the text of the row
+};
+
+// struct to hold everything that belongs to one open file
+typedef struct editorBuffer{
+	struct editorConfig state; // text, cursor and view of the buffer
+	undoRedo ur; // undo history of the buffer
+	int unloaded; // set for a buffer restored from a session, its file is only read once it is shown
+	unsigned long long savedhash; // hash of the text when it was last loaded or saved
+	unsigned long long* savedrows; // hashes of the rows when the text was last loaded or saved
+	int savedn; // no. of rows when the text was last loaded or saved, -1 if it never matched the disk
+	struct editorMark marks[YETI_MARKS]; // named marks of the buffer
+	struct editorTask* diff; // newest diff of the buffer still on the pool, NULL if none
+} ebuf;
+
+// struct to hold the open buffers, the one being edited lives in state and ur and its slot is only brought up to date when switching away from it
+typedef struct bufferList{
+	ebuf* buffers; // slots of the open buffers
+	int size; // no. of open buffers
+	int curr; // index of the buffer being edited
+} bufferList;
+
+bufferList bl; // stores the open buffers
+
+// struct to hold the positions jumped from, oldest first
+struct editorJumpList{
+	struct editorMark* items; // the positions
+	int size; // no. of positions
+	int curr; // index of the position a back jump goes before, size unless jumping back and forth
+};
+
+struct editorJumpList jumps = {NULL, 0, 0}; // stores the jump list
+
+// struct to hold a window showing a buffer on a part of the screen
+typedef struct editorWindow{
+	int buf; // index of the buffer shown in the window
+	int cx, cy, rx; // cursor position of the window
+	int rowoff, coloff; // view offsets of the window
+	int top, left; // screen position of the top-left corner of the window
+	int rows; // height of the window including its status bar
+	int cols; // width of the window, a separator column follows it unless it touches the right edge of the screen
+	char** lines; // last contents drawn on each screen line of the window
+	int* lens; // lengths of the last drawn lines
+	int drawnrowoff; // rowoff the lines were last drawn at
+} ewin;
+
+// struct to hold the bytes read from a terminal that were not decoded into keys yet
+struct editorInput{
+	unsigned char buf[YETI_INPUT_SIZE]; // ring buffer of the bytes
+	int head; // index of the first byte
+	int len; // no. of bytes held
+	long long escdue; // ms on the monotonic clock a started escape sequence stops waiting for the rest of it, 0 if none is waiting
+	int held[YETI_HELD_KEYS]; // keys typed while a long edit ran, handled once it is over
+	int nheld; // no. of keys held
+};
+
+// struct to hold the bytes of frames the terminal did not take yet, they are written as it drains
+struct editorOutput{
+	char* b; // the bytes waiting
+	int len; // no. of bytes in b
+	int sent; // no. of bytes at the start of b already written
+};
+
+// struct to hold the windows that tile the screen, the cursor and view of the active one live in state while it is active
+typedef struct windowList{
+	ewin* wins; // the windows
+	int size; // no. of windows
+	int curr; // index of the active window
+	int screenrows; // height of the terminal
+	int screencols; // width of the terminal
+	char* msgline; // last contents drawn on the message bar
+	int msglen; // length of the last drawn message bar
+	int infd; // descriptor the keys of this screen are read from
+	int outfd; // descriptor the frames of this screen are written to
+	struct editorInput in; // bytes read from infd that were not handled yet
+	struct editorOutput out; // bytes waiting to be written to outfd
+} windowList;
+
+windowList wl; // stores the windows
+
+// set when the editor runs as a server for terminals connecting over a unix socket
+int servermode = 0;
+
+// file status flags stdout had before it was made non blocking, -1 if it was not
+int outflags = -1;
+
+// struct to hold a terminal connected to the server
+typedef struct editorClient{
+	windowList wl; // windows and screen of the client, kept in the global wl while the client is selected
+	int gone; // set once the client quit or hung up
+} eclient;
+
+// struct to hold the clients of the server
+typedef struct clientList{
+	eclient* clients; // the connected clients
+	int size; // no. of connected clients
+	int curr; // index of the client whose windows are in wl, -1 if none
+} clientList;
+
+clientList cl; // stores the clients of the server
+
 /***UTILS***/
 
 // func to resixe the undoRedo states i.e to add a state or remove
@@ -140,8 +466,23 @@ void editorResizeUR(int n){
 	ur.states = new_states;
 }
 
+// func to check whether two states hold the same text by their hashes
+int editorSameText(const struct editorConfig* a, const struct editorConfig* b){
+	if(a->hash != b->hash || a->textrows != b->textrows) return 0;
+	for(int j = 0; j < a->textrows; j++){
+		if(a->row[j].hash != b->row[j].hash) return 0;
+	}
+	return 1;
+}
+
 // adds a state to the undoRedo struct
 void editorAddState(){
+	// batch scripts cannot undo so there is no point in cloning the whole text after every command
+	if(batchmode) return;
+
+	// a state with the same text as the last one would make undo seem to do nothing
+	if(ur.size && editorSameText(&ur.states[ur.size - 1], &state)) return;
+
 	// the pointer to the cloned state is fetched
 	struct editorConfig* cloned = ur.clone(&state);
 
@@ -159,6 +500,27 @@ void editorAddState(){
 	ur.currStateIndex = ur.size - 1;
 }
 
+// func to hash n bytes eight at a time, the tail and the length go into the last round
+unsigned long long editorHashBytes(const char* s, int n){
+	unsigned long long h = 0x9E3779B97F4A7C15ULL ^ (unsigned long long)n;
+	unsigned long long w;
+	int j = 0;
+	for(; j + 8 <= n; j += 8){
+		memcpy(&w, &s[j], 8);
+		h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+		h ^= h >> 31;
+	}
+	w = 0;
+	memcpy(&w, &s[j], n - j);
+	h = (h ^ w) * 0x94D049BB133111EBULL;
+
+	// final mix so every input bit reaches every output bit
+	h ^= h >> 32;
+	h *= 0xD6E8FEB86659FD93ULL;
+	h ^= h >> 32;
+	return h;
+}
+
 // func to decide line no col width
 int calculateDigits(int num){
 	int len = 0;
@@ -169,19 +531,719 @@ int calculateDigits(int num){
 	return len;
 }
 
+// func to add an input to the end of a history, a repeat of the last input is not added again and the oldest input is dropped once it is full
+void editorHistoryAdd(struct editorHistory* hist, const char* item){
+	if(hist->size && strcmp(hist->items[hist->size - 1], item) == 0) return;
+	if(hist->size == YETI_HISTORY_MAX){
+		free(hist->items[0]);
+		memmove(&hist->items[0], &hist->items[1], sizeof(char*) * --hist->size);
+	}
+	hist->items = realloc(hist->items, sizeof(char*) * (hist->size + 1));
+	hist->items[hist->size++] = strdup(item);
+}
+
+/***THREADS***/
+
+// struct to hold a piece of work for the pool of threads
+struct editorTask{
+	void (*run)(struct editorTask* t); // func doing the work on whichever thread gets to the task first
+	void (*done)(struct editorTask* t); // func run on the main thread once the task is over, NULL for the tasks of a group
+	int queue; // queue the task was put on
+	int cancelled; // set once the task is cancelled, a running task may look at it to stop early
+	struct editorTaskGroup* group; // group a thread waits for the task with, NULL for tasks whose end is posted to the main loop
+	long long over; // us on the monotonic clock the task was put on a ring
+};
+
+// struct to hold the no. of tasks of a group that are not over yet
+struct editorTaskGroup{
+	int left; // tasks not over yet
+	pthread_mutex_t lock; // guards left
+	pthread_cond_t over; // signalled when left drops to 0
+};
+
+// struct to hold the tasks queued on one worker, the worker takes the newest one and idle workers steal the oldest
+struct editorDeque{
+	pthread_mutex_t lock; // guards the rest
+	struct editorTask** items; // ring of the tasks
+	int head; // index of the oldest task
+	int len; // no. of tasks
+	int cap; // no. of tasks there is space for
+};
+
+// struct to hold the tasks one thread finished for the main loop, only that thread adds to it and only the main loop takes from it so neither side locks
+struct editorRing{
+	struct editorTask* items[YETI_RING_SIZE]; // the tasks
+	unsigned int head; // slot the main loop takes next, only written by it
+	unsigned int tail; // slot the thread fills next, only written by it
+	unsigned long long posted; // no. of tasks put on the ring, only written by the thread
+	unsigned int maxdepth; // most tasks that were waiting at once, only written by the thread
+	unsigned long long taken; // no. of tasks taken, only written by the main loop
+	long long waited; // total us the taken tasks waited, only written by the main loop
+	long long maxwait; // longest us a task waited, only written by the main loop
+};
+
+// struct to hold the pool of worker threads, started on first use and kept for the life of the editor
+struct editorPool{
+	int size; // no. of workers, 0 till the pool is started
+	struct editorDeque queues[YETI_MAX_THREADS]; // a queue per worker
+	int next; // queue the next task goes on
+	pthread_mutex_t lock; // guards queued
+	pthread_cond_t wake; // signalled when a task is queued
+	int queued; // no. of tasks in the queues
+	int efd; // eventfd bumped when a task for the main loop is over
+	struct editorRing rings[YETI_MAX_THREADS + 1]; // tasks that are over, a ring per worker and the last one for the main thread
+	int outstanding; // tasks for the main loop that were not handed back yet, only used on the main thread
+} pool;
+
+// func to take a task from a queue, the newest for its own worker and the oldest for a thief, returns NULL if it is empty
+struct editorTask* editorDequeTake(struct editorDeque* q, int newest){
+	struct editorTask* t = NULL;
+	pthread_mutex_lock(&q->lock);
+	if(q->len){
+		if(newest) t = q->items[(q->head + q->len - 1) % q->cap];
+		else {
+			t = q->items[q->head];
+			q->head = (q->head + 1) % q->cap;
+		}
+		q->len--;
+	}
+	pthread_mutex_unlock(&q->lock);
+	return t;
+}
+
+// func to take a given task out of a queue, returns 1 if it was still there
+int editorDequeRemove(struct editorDeque* q, struct editorTask* t){
+	int found = 0;
+	pthread_mutex_lock(&q->lock);
+	for(int j = 0; j < q->len; j++){
+		if(q->items[(q->head + j) % q->cap] != t) continue;
+		for(; j < q->len - 1; j++) q->items[(q->head + j) % q->cap] = q->items[(q->head + j + 1) % q->cap];
+		q->len--;
+		found = 1;
+		break;
+	}
+	pthread_mutex_unlock(&q->lock);
+	return found;
+}
+
+// func to add a task to a queue
+void editorDequePush(struct editorDeque* q, struct editorTask* t){
+	pthread_mutex_lock(&q->lock);
+	if(q->len == q->cap){
+		int cap = q->cap ? q->cap * 2 : 16;
+		struct editorTask** items = malloc(sizeof(struct editorTask*) * cap);
+		for(int j = 0; j < q->len; j++) items[j] = q->items[(q->head + j) % q->cap];
+		free(q->items);
+		q->items = items;
+		q->head = 0;
+		q->cap = cap;
+	}
+	q->items[(q->head + q->len++) % q->cap] = t;
+	pthread_mutex_unlock(&q->lock);
+}
+
+// func to get the time on the monotonic clock in us
+long long editorClockUs(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// func to put a task on a ring, run only by the thread owning it, a full ring is waited on since the main loop empties it whenever the eventfd wakes it up
+void editorRingPush(struct editorRing* r, struct editorTask* t){
+	unsigned int tail = r->tail;
+	unsigned int head;
+	while(tail - (head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)) == YETI_RING_SIZE) sched_yield();
+
+	r->items[tail % YETI_RING_SIZE] = t;
+	__atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+
+	// the counters are only read by the stats so they need no ordering
+	__atomic_store_n(&r->posted, r->posted + 1, __ATOMIC_RELAXED);
+	if(tail + 1 - head > r->maxdepth) __atomic_store_n(&r->maxdepth, tail + 1 - head, __ATOMIC_RELAXED);
+}
+
+// func to take the oldest task off a ring, run only by the main loop, returns NULL if it is empty
+struct editorTask* editorRingTake(struct editorRing* r){
+	unsigned int head = r->head;
+	if(head == __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) return NULL;
+
+	struct editorTask* t = r->items[head % YETI_RING_SIZE];
+	__atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+	return t;
+}
+
+// func to mark a task as over on the given ring, a group is told directly and the main loop through the eventfd
+void editorTaskOver(struct editorTask* t, int ring){
+	if(t->group){
+		pthread_mutex_lock(&t->group->lock);
+		if(--t->group->left == 0) pthread_cond_broadcast(&t->group->over);
+		pthread_mutex_unlock(&t->group->lock);
+		return;
+	}
+
+	t->over = editorClockUs();
+	editorRingPush(&pool.rings[ring], t);
+
+	uint64_t one = 1;
+	if(pool.size) while(write(pool.efd, &one, sizeof(one)) == -1 && errno == EINTR);
+}
+
+// func to run a task and mark it as over on the ring of the thread running it
+void editorTaskRun(struct editorTask* t, int ring){
+	t->run(t);
+	editorTaskOver(t, ring);
+}
+
+// entry point of each worker, it runs its own tasks newest first and steals the oldest ones of the others when it runs out
+void* editorPoolWorker(void* p){
+	int id = (int)(intptr_t)p;
+	while(1){
+		struct editorTask* t = editorDequeTake(&pool.queues[id], 1);
+		for(int k = 1; t == NULL && k < pool.size; k++) t = editorDequeTake(&pool.queues[(id + k) % pool.size], 0);
+
+		pthread_mutex_lock(&pool.lock);
+		if(t == NULL){
+			while(pool.queued == 0) pthread_cond_wait(&pool.wake, &pool.lock);
+			pthread_mutex_unlock(&pool.lock);
+			continue;
+		}
+		pool.queued--;
+		pthread_mutex_unlock(&pool.lock);
+
+		editorTaskRun(t, id);
+	}
+	return NULL;
+}
+
+// func to start the workers, one less than the cpus since the thread handing out work does its share too but always at least one for the background tasks, returns -1 if none could be started
+int editorPoolStart(){
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int size = cpus - 1;
+	if(size > YETI_MAX_THREADS) size = YETI_MAX_THREADS;
+	if(size < 1) size = 1;
+
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.wake, NULL);
+	pool.efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(pool.efd == -1) return -1;
+
+	// the workers never touch the terminal so they leave every signal to the main thread
+	sigset_t all, old;
+	sigfillset(&all);
+	pthread_sigmask(SIG_BLOCK, &all, &old);
+	// the size is set before any worker looks at it, the queue of a worker that failed to start is emptied by the others stealing from it
+	for(int j = 0; j < size; j++) pthread_mutex_init(&pool.queues[j].lock, NULL);
+	pool.size = size;
+	int started = 0;
+	for(int j = 0; j < size; j++){
+		pthread_t thread;
+		if(pthread_create(&thread, NULL, editorPoolWorker, (void*)(intptr_t)j) != 0) continue;
+		pthread_detach(thread);
+		started++;
+	}
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if(started == 0){
+		pool.size = 0;
+		close(pool.efd);
+		return -1;
+	}
+	return 0;
+}
+
+// func to queue a task on the pool, a task without a group is handed back to the main loop once it is over
+void editorPoolSubmit(struct editorTask* t){
+	t->cancelled = 0;
+	if(t->group == NULL) pool.outstanding++;
+
+	// without threads the task is simply run now
+	if(pool.size == 0 && editorPoolStart() == -1){
+		editorTaskRun(t, YETI_MAX_THREADS);
+		return;
+	}
+	t->queue = pool.next++ % pool.size;
+	editorDequePush(&pool.queues[t->queue], t);
+
+	pthread_mutex_lock(&pool.lock);
+	pool.queued++;
+	pthread_cond_signal(&pool.wake);
+	pthread_mutex_unlock(&pool.lock);
+}
+
+// func to take a task back from the pool before a worker got to it, returns 1 if it was still queued
+int editorPoolRetract(struct editorTask* t){
+	if(pool.size == 0 || !editorDequeRemove(&pool.queues[t->queue], t)) return 0;
+
+	pthread_mutex_lock(&pool.lock);
+	pool.queued--;
+	pthread_mutex_unlock(&pool.lock);
+	return 1;
+}
+
+// func to cancel a task, one that did not start yet never runs and one that is running is asked to stop, either way its done func still runs
+void editorPoolCancel(struct editorTask* t){
+	__atomic_store_n(&t->cancelled, 1, __ATOMIC_RELEASE);
+	if(editorPoolRetract(t)) editorTaskOver(t, YETI_MAX_THREADS);
+}
+
+// func to check from a running task whether it was cancelled
+int editorTaskCancelled(struct editorTask* t){
+	return __atomic_load_n(&t->cancelled, __ATOMIC_ACQUIRE);
+}
+
+// func to add the eventfd of the pool to a poll set, returns the no. of entries added
+int editorPoolPollFd(struct pollfd* fd){
+	if(pool.size == 0) return 0;
+	*fd = (struct pollfd){pool.efd, POLLIN, 0};
+	return 1;
+}
+
+// func to clear the eventfd once it woke the editor up, the tasks stay in the done list till the main loop takes them
+void editorPoolWake(){
+	uint64_t n;
+	if(pool.size) while(read(pool.efd, &n, sizeof(n)) == -1 && errno == EINTR);
+}
+
+// func to check whether tasks are over and wait for the main loop
+int editorPoolDone(){
+	for(int j = 0; j <= YETI_MAX_THREADS; j++){
+		if(pool.rings[j].head != __atomic_load_n(&pool.rings[j].tail, __ATOMIC_ACQUIRE)) return 1;
+	}
+	return 0;
+}
+
+// func to hand the tasks that are over back to the main thread by running their done funcs, each ring in the order its thread finished them, returns how many there were
+int editorPoolComplete(){
+	editorPoolWake();
+
+	int n = 0;
+	long long now = editorClockUs();
+	for(int j = 0; j <= YETI_MAX_THREADS; j++){
+		struct editorRing* r = &pool.rings[j];
+		struct editorTask* t;
+		while((t = editorRingTake(r))){
+			long long wait = now > t->over ? now - t->over : 0;
+			r->taken++;
+			r->waited += wait;
+			if(wait > r->maxwait) r->maxwait = wait;
+
+			pool.outstanding--;
+			if(t->done) t->done(t);
+			n++;
+		}
+	}
+	return n;
+}
+
+// func to wait for every task handed to the pool by the main thread, used where there is no main loop like batch mode
+void editorPoolWait(){
+	while(pool.outstanding){
+		struct pollfd fd = {pool.efd, POLLIN, 0};
+		if(!editorPoolDone()) poll(&fd, 1, -1);
+		editorPoolComplete();
+	}
+}
+
+// signature of the func run by each thread on its share of rows
+typedef void (*editorRangeFunc)(int lo, int hi, void* arg);
+
+// struct handed to each thread of a parallel pass
+struct editorRangeTask{
+	struct editorTask task; // the task queued on the pool, first so the task is the range task
+	editorRangeFunc fn; // func to run
+	int lo, hi; // range of items the thread works on
+	void* arg; // argument shared by all the threads
+};
+
+// func run by the pool for each chunk of a parallel pass
+void editorRangeRun(struct editorTask* t){
+	struct editorRangeTask* task = (struct editorRangeTask*)t;
+	task->fn(task->lo, task->hi, task->arg);
+}
+
+// func to split the items [0, n) into contiguous chunks and run them on the pool, returns the no. of chunks used
+int editorParallelFor(int n, int grain, editorRangeFunc fn, void* arg){
+	// decide the no. of chunks based on the no. of cores and the minimum chunk size
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int chunks = (grain > 0) ? n / grain : 1;
+	if(chunks > cpus) chunks = cpus;
+	if(chunks > YETI_MAX_THREADS) chunks = YETI_MAX_THREADS;
+	if(chunks < 1) chunks = 1;
+
+	struct editorRangeTask tasks[YETI_MAX_THREADS];
+	struct editorTaskGroup group;
+	group.left = chunks - 1;
+	pthread_mutex_init(&group.lock, NULL);
+	pthread_cond_init(&group.over, NULL);
+
+	for(int i = 0; i < chunks; i++){
+		tasks[i].task.run = editorRangeRun;
+		tasks[i].task.done = NULL;
+		tasks[i].task.group = &group;
+		tasks[i].fn = fn;
+		tasks[i].lo = (int)((long long)n * i / chunks);
+		tasks[i].hi = (int)((long long)n * (i + 1) / chunks);
+		tasks[i].arg = arg;
+		if(i) editorPoolSubmit(&tasks[i].task);
+	}
+
+	// the first chunk is run on the calling thread, and so is every chunk no worker got to yet since they may all be busy with background tasks
+	fn(tasks[0].lo, tasks[0].hi, arg);
+	for(int i = 1; i < chunks; i++){
+		if(editorPoolRetract(&tasks[i].task)) editorTaskRun(&tasks[i].task, YETI_MAX_THREADS);
+	}
+
+	// wait for the chunks the workers took
+	pthread_mutex_lock(&group.lock);
+	while(group.left) pthread_cond_wait(&group.over, &group.lock);
+	pthread_mutex_unlock(&group.lock);
+	pthread_mutex_destroy(&group.lock);
+	pthread_cond_destroy(&group.over);
+
+	return chunks;
+}
+
+/***SIMD***/
+
+// func to count the occurrences of a byte, 16 bytes at a time where sse2 is available
+int editorCountByte(const char* s, int n, char c){
+	int count = 0, j = 0;
+#ifdef __SSE2__
+	__m128i needle = _mm_set1_epi8(c);
+	for(; j + 16 <= n; j += 16){
+		__m128i block = _mm_loadu_si128((const __m128i*)(s + j));
+		count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+	}
+#endif
+	for(; j < n; j++){
+		if(s[j] == c) count++;
+	}
+	return count;
+}
+
+// func to find the index of the last char that is not a space (or a tab if tabs is set) scanning backwards 16 bytes at a time, returns -1 if there is none
+int editorLastNonBlank(const char* s, int n, int tabs){
+	int j = n;
+#ifdef __SSE2__
+	__m128i space = _mm_set1_epi8(' ');
+	__m128i tab = _mm_set1_epi8(tabs ? '\t' : ' ');
+	for(; j >= 16; j -= 16){
+		__m128i block = _mm_loadu_si128((const __m128i*)(s + j - 16));
+		int blank = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)));
+
+		// the highest clear bit is the last non blank char of the block
+		if(blank != 0xFFFF) return j - 16 + (31 - __builtin_clz(~blank & 0xFFFF));
+	}
+#endif
+	while(j > 0 && (s[j-1] == ' ' || (tabs && s[j-1] == '\t'))) j--;
+	return j - 1;
+}
+
+// func to copy n chars to dst expanding the tabs to spaces, the runs between tabs are copied whole, returns the length written
+int editorExpandTabs(const char* src, int n, char* dst){
+	int idx = 0;
+	const char* p = src;
+	const char* end = src + n;
+	const char* tab;
+	while((tab = memchr(p, '\t', end - p)) != NULL){
+		memcpy(&dst[idx], p, tab - p);
+		idx += tab - p;
+		dst[idx++] = ' ';
+		while(idx % YETI_TAB_STOP != 0) dst[idx++] = ' ';
+		p = tab + 1;
+	}
+	memcpy(&dst[idx], p, end - p);
+	return idx + (end - p);
+}
+
+// func to find the first occurrence of needle in the n bytes at s, the candidates are found by matching its first and last byte against 16 positions at a time where sse2 is available, returns NULL if there is none
+const char* editorMemSearch(const char* s, size_t n, const char* needle, size_t m){
+	if(m == 0) return s;
+	if(n < m) return NULL;
+	size_t j = 0;
+#ifdef __SSE2__
+	if(m > 1){
+		__m128i first = _mm_set1_epi8(needle[0]);
+		__m128i last = _mm_set1_epi8(needle[m - 1]);
+		for(; j + m - 1 + 16 <= n; j += 16){
+			__m128i a = _mm_loadu_si128((const __m128i*)(s + j));
+			__m128i b = _mm_loadu_si128((const __m128i*)(s + j + m - 1));
+			int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+			while(mask){
+				int bit = __builtin_ctz(mask);
+				if(memcmp(s + j + bit + 1, needle + 1, m - 2) == 0) return s + j + bit;
+				mask &= mask - 1;
+			}
+		}
+	}
+#endif
+	return memmem(s + j, n - j, needle, m);
+}
+
+// func to find the last occurrence of needle in the n bytes at s, returns NULL if there is none
+const char* editorMemSearchBack(const char* s, size_t n, const char* needle, size_t m){
+	if(m == 0 || n < m) return NULL;
+
+	// candidates start before end
+	size_t end = n - m + 1;
+	const char* p;
+	while(end > 0 && (p = memrchr(s, needle[0], end)) != NULL){
+		if(memcmp(p + 1, needle + 1, m - 1) == 0) return p;
+		end = p - s;
+	}
+	return NULL;
+}
+
 /***PROTOTYPE***/
 
 void editorSetStatusMessage(const char *fmt, ...);
 void editorRefreshScreen();
-char* editorPrompt(char* prompt, void (*callback)(char* , int));
+char* editorPrompt(char* prompt, struct editorHistory* hist, void (*callback)(char* , int), char* (*complete)(const char*));
+int editorTransformLines(int start, int end, enum editorTransform kind);
+void editorWindowsBufferClosed(int closed);
+void editorJumpPush(int cy, int cx);
+void editorJumpsBufferClosed(int closed);
+int editorGotoBuffer(int n);
+int editorOpen(char *filename);
+int editorSaveSession();
+void editorLoadBuffer();
+int editorMessageExpired();
+int editorAutosave();
+int editorReapJobs();
+void editorRefreshMessageBar();
+int editorFlushOutput(windowList* l);
+int editorFindRow(unsigned int id, int line);
+void editorClampCursor();
+void editorJobsBufferClosed(int closed);
+int editorRunJobs();
+int editorJobsDone();
+int editorJobsPollFds(struct pollfd* fds);
+int editorFinishJobs();
+int editorJobStatus(int buf, char* s, int size);
+char* editorCompleteCommand(const char* input);
+void editorQueueOutput(const char* b, int len);
+void editorPagerRefresh();
+int editorIsBinary(const char* filename);
+int editorReadCompressedRows(FILE* fp);
+int editorWriteCompressed();
+void initEditor();
+
+/***TIMERS***/
+
+// the timers of the editor
+enum editorTimerId{
+	TIMER_MESSAGE, // clears the status message
+	TIMER_AUTOSAVE, // saves the session now and then
+	TIMER_REAP, // collects the commands of cancelled jobs
+	TIMER_COUNT
+};
+
+// struct to hold a timer, armed timers are chained in the slot of the wheel their due time falls in
+struct editorTimer{
+	long long due; // ms on the monotonic clock the timer fires at
+	int armed; // set while the timer is in the wheel
+	int next; // next timer in the same slot, -1 at the end
+	int (*fire)(); // func run when the timer fires, returns 1 if the screen needs redrawing
+};
+
+// struct to hold the timer wheel, each slot covers YETI_TIMER_TICK_MS and a timer due more than a turn ahead waits in its slot for its turn
+struct editorTimerWheel{
+	struct editorTimer timers[TIMER_COUNT]; // the timers by id
+	int slots[YETI_TIMER_SLOTS]; // first timer of each slot, -1 if none
+	long long tick; // last tick the wheel was turned to, 0 until the first timer is armed
+} timerwheel = {
+	{{0, 0, -1, editorMessageExpired}, {0, 0, -1, editorAutosave}, {0, 0, -1, editorReapJobs}},
+	{0},
+	0
+};
+
+// func to read the monotonic clock in ms, only called when timers are set or the editor wakes up and never per frame
+long long editorNow(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// func to take a timer out of the slot it is chained in
+void editorTimerStop(int id){
+	struct editorTimer* t = &timerwheel.timers[id];
+	if(!t->armed) return;
+
+	int* link = &timerwheel.slots[(t->due / YETI_TIMER_TICK_MS) % YETI_TIMER_SLOTS];
+	while(*link != id) link = &timerwheel.timers[*link].next;
+	*link = t->next;
+	t->armed = 0;
+}
+
+// func to arm a timer to fire in ms, a timer that was already armed is moved
+void editorTimerStart(int id, int ms){
+	editorTimerStop(id);
+
+	long long now = editorNow();
+	if(timerwheel.tick == 0){
+		for(int j = 0; j < YETI_TIMER_SLOTS; j++) timerwheel.slots[j] = -1;
+		timerwheel.tick = now / YETI_TIMER_TICK_MS;
+	}
+
+	struct editorTimer* t = &timerwheel.timers[id];
+	t->due = now + ms;
+	t->armed = 1;
+	int slot = (t->due / YETI_TIMER_TICK_MS) % YETI_TIMER_SLOTS;
+	t->next = timerwheel.slots[slot];
+	timerwheel.slots[slot] = id;
+}
+
+// func to get the ms until the next timer fires, -1 if none is armed
+int editorTimerTimeout(){
+	long long due = -1;
+	for(int j = 0; j < TIMER_COUNT; j++){
+		struct editorTimer* t = &timerwheel.timers[j];
+		if(t->armed && (due == -1 || t->due < due)) due = t->due;
+	}
+	if(due == -1) return -1;
+
+	long long left = due - editorNow();
+	return left > 0 ? (int)left : 0;
+}
+
+// func to turn the wheel up to now and fire the timers that are due, returns 1 if any of them needs the screen redrawn
+int editorRunTimers(){
+	if(timerwheel.tick == 0) return 0;
+
+	long long now = editorNow();
+	long long tick = now / YETI_TIMER_TICK_MS;
+	int redraw = 0;
+
+	// only a full turn needs visiting however long the editor slept
+	long long from = timerwheel.tick;
+	if(tick - from >= YETI_TIMER_SLOTS) from = tick - YETI_TIMER_SLOTS + 1;
+	for(long long k = from; k <= tick; k++){
+		int id = timerwheel.slots[k % YETI_TIMER_SLOTS];
+		while(id != -1){
+			struct editorTimer* t = &timerwheel.timers[id];
+			int next = t->next;
+			if(t->due <= now){
+				editorTimerStop(id);
+				redraw |= t->fire();
+			}
+			id = next;
+		}
+	}
+	timerwheel.tick = tick;
+	return redraw;
+}
+
+// func run when a status message is old enough to go away
+int editorMessageExpired(){
+	state.statusmsg[0] = '\0';
+	return 1;
+}
+
+// func run now and then to save the session so a crash loses no more than the positions since the last save
+int editorAutosave(){
+	editorSaveSession();
+	editorTimerStart(TIMER_AUTOSAVE, YETI_AUTOSAVE_MS);
+	return 0;
+}
+
+/***WORK***/
+
+// struct to hold a long edit that runs on the main thread a slice at a time between keys, so the screen keeps up and escape can cancel it
+struct editorWork{
+	int active; // set while an edit is under way
+	int (*step)(long long due); // func doing the edit till due (ms on the monotonic clock) or till it is done, returns 1 once it is done
+	void (*finish)(int cancelled); // func wrapping the edit up, also run with what was done so far when it is cancelled
+	char label[24]; // shown in the status bar
+	int buf; // buffer being edited
+	int start, end; // rows edited
+	int next; // first row not done yet, the edit picks up from there
+	int count; // no. of changes made so far
+	int percent; // how far the edit got
+
+	// edits going a row at a time
+	int (*row)(int j); // func to edit one row, returns the no. of changes
+	const char* what; // what the changes are, for the message at the end
+	char* old; // text replaced by a substitution
+	size_t oldlen; // length of old
+	char* new; // text it is replaced with
+	size_t newlen; // length of new
+	int global; // set if every match of a row is replaced
+
+	// sort
+	erow* src; // copy of the rows being sorted, the buffer only gets them at the end
+	erow* dst; // scratch space the runs are merged into
+	int width; // length of the runs merged in this pass, 0 while the short runs are still being sorted
+	int lo; // start of the runs being merged
+	int i, j, k; // positions in the left and right run and in dst
+	int pass; // no. of passes done
+	int passes; // no. of passes in all
+} work;
+
+// func to start the edit set up in work, it is done at once in batch and server mode and else gets a first slice now and the rest between keys
+void editorWorkStart(const char* label){
+	snprintf(work.label, sizeof(work.label), "%s", label);
+	work.buf = bl.curr;
+	work.count = 0;
+	work.percent = 0;
+
+	long long due = (batchmode || servermode) ? LLONG_MAX : editorNow() + YETI_WORK_SLICE_MS;
+	if(work.step(due)){
+		work.finish(0);
+		return;
+	}
+	work.active = 1;
+}
+
+// func to run the next slice of the edit under way
+void editorRunWork(){
+	if(!work.active || !work.step(editorNow() + YETI_WORK_SLICE_MS)) return;
+	work.active = 0;
+	work.finish(0);
+}
+
+// func to cancel the edit under way, the rows it got to stay edited
+void editorCancelWork(){
+	if(!work.active) return;
+	work.active = 0;
+	work.finish(1);
+}
+
+// func to edit the rows of the edit under way one after the other, used as the step of the edits going a row at a time
+int editorWorkRows(long long due){
+	while(work.next < work.end){
+		work.count += work.row(work.next++);
+
+		// the clock is only looked at every so often
+		if((work.next & 63) == 0 && editorNow() >= due) break;
+	}
+	work.percent = work.end > work.start ? (int)((long long)(work.next - work.start) * 100 / (work.end - work.start)) : 100;
+	return work.next == work.end;
+}
+
+// func to wrap up an edit going a row at a time, a single undo state covers the rows it changed
+void editorWorkRowsFinish(int cancelled){
+	free(work.old);
+	free(work.new);
+	work.old = work.new = NULL;
+
+	editorClampCursor();
+	if(work.count){
+		state.edits++;
+		editorAddState();
+	}
+	if(cancelled) editorSetStatusMessage("%s cancelled after %d of %d lines, %d %s", work.label, work.next - work.start, work.end - work.start, work.count, work.what);
+	else editorSetStatusMessage("%d %s", work.count, work.what);
+}
 
 /***TERMINAL***/
 
 // function to print error (in case there is any) and exit the program
 void die(const char* s){
 	// tells the terminal to clear the screen and postion the cursor to the top-left
-	write(STDOUT_FILENO, "\x1b[2J", 4);
-	write(STDOUT_FILENO, "\x1b[H", 3);
+	if(!batchmode){
+		write(STDOUT_FILENO, "\x1b[2J", 4);
+		write(STDOUT_FILENO, "\x1b[H", 3);
+	}
 	
 	// prints out a description of the error based on the global errorno set by the failed function
 	perror(s);
@@ -192,6 +1254,11 @@ void die(const char* s){
 
 // function to restore the original attributes of the terminal on exit
 void disableRawMode(){
+	// stdout blocks again like the shell expects
+	if(outflags != -1) fcntl(STDOUT_FILENO, F_SETFL, outflags);
+
+	// stop the mouse reports turned on with raw mode
+	write(STDOUT_FILENO, "\x1b[?1006l\x1b[?1002l\x1b[?1000l", 24);
 	system("clear");
 	// setting the default attributes back before exiting
 	if(tcsetattr(STDIN_FILENO, TCSAFLUSH, &state.orig) == -1) die("tcsetattr");
@@ -225,92 +1292,274 @@ void enableRawMode(){
 	// IEXTEN -> turns off ctrl-v
 	modified.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
 	
-	// sets  a timeout so that read() returns if it does not get any input for 100ms
+	// sets  a timeout so that read() returns if it does not get any input for 100ms, keys are polled for first so this only matters for replies to queries
 	modified.c_cc[VMIN] = 0;
 	modified.c_cc[VTIME] = 1;
 
 	// setting the changes to the terminal
 	if(tcsetattr(STDIN_FILENO, TCSAFLUSH, &modified) == -1) die("tcsetattr");
 
+	// ask for clicks, drags with a button held and wheel steps to be reported in the sgr format, which has no limit on the screen size
+	write(STDOUT_FILENO, "\x1b[?1000h\x1b[?1002h\x1b[?1006h", 24);
+
 }
 
 
-// func that reads each keypress
-int editorReadKey(){
-	// variables to store the response and the character respectively
-	int nread;
-	char c;
+// special keys sent as ESC [ n ~, indexed by n
+static const int editorTildeKeys[] = {
+	[1] = HOME_KEY, [2] = INSERT_KEY, [3] = DEL_KEY, [4] = END_KEY, [5] = PAGE_UP, [6] = PAGE_DOWN, [7] = HOME_KEY, [8] = END_KEY,
+	[11] = F1_KEY, [12] = F2_KEY, [13] = F3_KEY, [14] = F4_KEY, [15] = F5_KEY,
+	[17] = F6_KEY, [18] = F7_KEY, [19] = F8_KEY, [20] = F9_KEY, [21] = F10_KEY,
+	[23] = F11_KEY, [24] = F12_KEY
+};
 
-	// check if we were able to read the byte
-	while((nread = read(STDIN_FILENO, &c, 1)) != 1){
-		// if not exit the program
-		if(nread == -1 && errno != EAGAIN) die("read");
-	}
-	
-	// trying to check if arrow keys are useed since they are represented by 3 bytes and start as an escape sequence, followed by ']' and then A or B or C or D
-	if(c == '\x1b'){
-		char seq[3];
-
-		if(read(STDIN_FILENO, &seq[0], 1) != 1) return '\x1b';
-		if(read(STDIN_FILENO, &seq[1], 1) != 1) return '\x1b';
-
-		if(seq[0] == '['){
-			if(seq[1] >= '0' && seq[1] <= '9'){
-				if(read(STDIN_FILENO, &seq[2], 1) != 1) return '\x1b';
-				if(seq[2] == '~'){
-					switch(seq[1]){
-						case '1': return HOME_KEY;
-						case '3': return DEL_KEY;
-						case '4': return END_KEY;
-						case '5': return PAGE_UP;
-						case '6': return PAGE_DOWN;
-						case '7': return HOME_KEY;
-						case '8': return END_KEY;
-					}
-				}
-			} else {
-				switch(seq[1]){
-					case 'A': return ARROW_UP;
-					case 'B': return ARROW_DOWN;
-					case 'C': return ARROW_RIGHT;
-					case 'D': return ARROW_LEFT;
-					case 'H': return HOME_KEY;
-					case 'F': return END_KEY;
-				}
-			}
-		} else if(seq[0] == 'O'){
-			switch(seq[1]){
-				case 'H': return HOME_KEY;
-				case 'F': return END_KEY;
-			}
-		}
+// special keys sent as ESC [ letter or ESC O letter, indexed by the letter
+static const int editorFinalKeys[128] = {
+	['A'] = ARROW_UP, ['B'] = ARROW_DOWN, ['C'] = ARROW_RIGHT, ['D'] = ARROW_LEFT,
+	['H'] = HOME_KEY, ['F'] = END_KEY,
+	['P'] = F1_KEY, ['Q'] = F2_KEY, ['R'] = F3_KEY, ['S'] = F4_KEY
+};
 
-		return '\x1b';
-	} else { 
-		return c;
-	}
+// func to get byte j of the buffered input
+int editorInputByte(struct editorInput* in, int j){
+	return in->buf[(in->head + j) & (YETI_INPUT_SIZE - 1)];
 }
 
-// func to get the current position of  the cursor
-int getCursorPosition(int* rows, int* cols){
-	// character buffer to store the response of the current cursor position
-	char buffer[32];
+// func to drop the first n bytes of the buffered input
+void editorInputConsume(struct editorInput* in, int n){
+	in->head = (in->head + n) & (YETI_INPUT_SIZE - 1);
+	in->len -= n;
+}
 
+// func to read whatever the terminal has into the free part of the ring buffer with one call, waiting up to timeout ms (-1 for ever), returns the no. of bytes read, 0 on a timeout and -1 once the other end hung up
+int editorInputFill(struct editorInput* in, int timeout){
+	// output still waiting for the terminal is written whenever it can take more, the pipes of the jobs and the tasks of the pool wake the editor up too
+	struct pollfd pfd[3 + 2 * YETI_JOBS_MAX] = {{wl.infd, POLLIN, 0}, {wl.outfd, POLLOUT, 0}};
+	int nfds = wl.out.len ? 2 : 1;
+	if(nfds == 2 && wl.outfd == wl.infd){
+		pfd[0].events |= POLLOUT;
+		nfds = 1;
+	}
+	nfds += editorJobsPollFds(&pfd[nfds]);
+	int poolfd = nfds;
+	nfds += editorPoolPollFd(&pfd[nfds]);
+
+	int ready;
+	while((ready = poll(pfd, nfds, timeout)) == -1 && errno == EINTR);
+	if(ready == -1) die("poll");
+	if(ready == 0) return 0;
+	if(wl.out.len && (pfd[0].revents | pfd[1].revents) & POLLOUT) editorFlushOutput(&wl);
+	if(poolfd < nfds && pfd[poolfd].revents) editorPoolWake();
+	if(!(pfd[0].revents & (POLLIN | POLLHUP | POLLERR))) return 0;
+
+	// the free space may wrap around the end of the ring
+	int tail = (in->head + in->len) & (YETI_INPUT_SIZE - 1);
+	int room = YETI_INPUT_SIZE - in->len;
+	int first = YETI_INPUT_SIZE - tail < room ? YETI_INPUT_SIZE - tail : room;
+	struct iovec iov[2] = {{&in->buf[tail], first}, {in->buf, room - first}};
+
+	ssize_t n;
+	while((n = readv(wl.infd, iov, room - first ? 2 : 1)) == -1 && errno == EINTR);
+	if(n == -1 && errno != EAGAIN) die("read");
+	if(n == 0 && ((pfd[0].revents & (POLLHUP | POLLERR)) || servermode)) return -1;
+	if(n <= 0) return 0;
+
+	in->len += n;
+	return n;
+}
 
-	unsigned int i = 0;
-	
-	// try to request the terminal for the current cursor position
-	if(write(STDOUT_FILENO, "\x1b[6n", 4) != 4) return -1;
+// func to decode the CSI sequence ESC [ ... at the start of the input, returns its length or 0 if it is cut off, the key goes into key
+int editorDecodeCSI(struct editorInput* in, int* key){
+	int params[4] = {0, 0, 0, 0};
+	int nparams = 0;
+	int marker = 0;
+	int j = 2;
+
+	// a private marker like the < of sgr mouse reports comes before the parameters
+	if(j < in->len && editorInputByte(in, j) >= '<' && editorInputByte(in, j) <= '?') marker = editorInputByte(in, j++);
+
+	// the parameters are numbers separated by semicolons, the intermediate bytes after them are skipped
+	for(; j < in->len && j < YETI_ESC_MAX; j++){
+		int b = editorInputByte(in, j);
+		if(b >= '0' && b <= '9'){
+			if(nparams == 0) nparams = 1;
+			if(nparams <= 4) params[nparams - 1] = params[nparams - 1] * 10 + (b - '0');
+		} else if(b == ';'){
+			if(nparams == 0) nparams = 1;
+			nparams++;
+		} else if(b < 0x20 || b > 0x2f) break;
+	}
+	if(j == in->len) return 0;
 
-	// read the response sent by the terminal into the char buffer
-	while(i < sizeof(buffer) - 1){
-		if(read(STDIN_FILENO, &buffer[i], 1) != 1) break;
-		if(buffer[i] == 'R') break;
-		i++;
+	int final = editorInputByte(in, j);
+	if(final < 0x40 || final > 0x7e){
+		*key = UNKNOWN_KEY;
+		return j;
 	}
-	
-	// makes the character buffer into a string in C
-	buffer[i] = '\0';
+
+	// sgr mouse reports are ESC [ < button ; x ; y followed by M when pressed and m when released
+	if(marker == '<' && (final == 'M' || final == 'm')){
+		mouse.button = params[0];
+		mouse.x = params[1] - 1;
+		mouse.y = params[2] - 1;
+		mouse.pressed = final == 'M';
+		*key = MOUSE_EVENT;
+		return j + 1;
+	}
+
+	int base = 0;
+	if(marker == 0 && final == '~' && params[0] < (int)(sizeof(editorTildeKeys) / sizeof(editorTildeKeys[0]))) base = editorTildeKeys[params[0]];
+	else if(marker == 0 && final != '~') base = editorFinalKeys[final];
+
+	// the second parameter holds the modifiers plus one, shift is 1, alt 2 and ctrl 4
+	int mods = nparams >= 2 && params[1] > 1 ? params[1] - 1 : 0;
+	*key = base ? base | (mods & 1 ? KEY_SHIFT : 0) | (mods & 2 ? KEY_ALT : 0) | (mods & 4 ? KEY_CTRL : 0) : UNKNOWN_KEY;
+	return j + 1;
+}
+
+// func to decode one key from the start of the input without removing it, its length goes into len, returns -1 if the bytes so far are the start of an escape sequence, unless final is set because no more bytes came within the timeout and they are taken as they are
+int editorScanKey(struct editorInput* in, int final, int* keylen){
+	if(in->len == 0) return -1;
+
+	// plain bytes are returned as a char like the editor always did so utf-8 text passes through unchanged
+	int c = editorInputByte(in, 0);
+	if(c != '\x1b'){
+		*keylen = 1;
+		return (char)c;
+	}
+
+	int key = '\x1b', len = 0;
+	if(in->len >= 2){
+		int next = editorInputByte(in, 1);
+		if(next == '[') len = editorDecodeCSI(in, &key);
+		else if(next == 'O'){
+			// ss3 sequences are a single letter
+			if(in->len >= 3){
+				int b = editorInputByte(in, 2);
+				key = b < 128 && editorFinalKeys[b] ? editorFinalKeys[b] : UNKNOWN_KEY;
+				len = 3;
+			}
+		} else {
+			// an escape followed by anything else is the escape key with that key typed after it
+			len = 1;
+		}
+	}
+
+	// a sequence cut off for too long, or one that never ends, leaves just the escape key and the rest as typed bytes
+	if(len == 0){
+		if(!final && in->len < YETI_ESC_MAX) return -1;
+		key = '\x1b';
+		len = 1;
+	}
+	*keylen = len;
+	return key;
+}
+
+// func to decode and remove one key from the start of the input, returns -1 if more bytes are needed as for editorScanKey
+int editorDecodeKey(struct editorInput* in, int final){
+	int len;
+	int key = editorScanKey(in, final, &len);
+	if(key != -1) editorInputConsume(in, len);
+	return key;
+}
+
+// func to check whether a whole key is buffered, so it can be handled without reading
+int editorKeyPending(){
+	int len;
+	return editorScanKey(&wl.in, 0, &len) != -1;
+}
+
+// func to remove the keys equal to key that directly follow in the buffered input, used to handle a held down key in one go, returns how many were removed
+int editorSkipRepeats(int key){
+	int n = 0, len;
+	while(editorScanKey(&wl.in, 0, &len) == key){
+		editorInputConsume(&wl.in, len);
+		n++;
+	}
+	return n;
+}
+
+// func that reads each keypress, the bytes are read in bulk and decoded from the buffer and only a lone escape waits for what follows it
+int editorReadKey(){
+	struct editorInput* in = &wl.in;
+
+	// a long edit looks for escape between its slices and leaves the other keys for later
+	int working = work.active && !prompting;
+
+	// the keys held back while a long edit ran come first once it is over
+	if(!working && in->nheld){
+		int key = in->held[0];
+		memmove(in->held, in->held + 1, sizeof(int) * --in->nheld);
+		return key;
+	}
+
+	while(1){
+		int key = editorDecodeKey(in, 0);
+
+		// a lone escape is only a key once nothing followed it in time
+		if(key == -1 && in->len && in->escdue && editorNow() >= in->escdue) key = editorDecodeKey(in, 1);
+		if(key != -1){
+			in->escdue = 0;
+			if(!working) return key;
+			if(key == '\x1b') return WORK_CANCEL;
+
+			// a mouse event only leaves its details in the global mouse, so one held back would be replayed with those of the last one, and it points at a screen that was not drawn yet anyway
+			if(key == MOUSE_EVENT) continue;
+			if(in->nheld < YETI_HELD_KEYS) in->held[in->nheld++] = key;
+			continue;
+		}
+
+		// a job or task that is done is reported like a key so its output is used between keys and never under a prompt or in the middle of a long edit
+		if(!prompting && !working && (editorJobsDone() || editorPoolDone())) return JOB_EVENT;
+
+		// the wait ends at whichever comes first of the escape timeout and the next timer, a long edit does not wait at all
+		int timeout = -1;
+		if(in->len){
+			if(in->escdue == 0) in->escdue = editorNow() + opts.esctimeout;
+			timeout = in->escdue - editorNow();
+			if(timeout < 0) timeout = 0;
+		}
+		int due = editorTimerTimeout();
+		if(due != -1 && (timeout == -1 || due < timeout)) timeout = due;
+		if(working) timeout = 0;
+
+		int n = editorInputFill(in, timeout);
+
+		// a client that hung up reads as escape so any prompt it left open gets cancelled
+		if(n == -1){
+			if(servermode) cl.clients[cl.curr].gone = 1;
+			else die("read");
+			return '\x1b';
+		}
+
+		if(editorRunTimers()) editorRefreshMessageBar();
+		if(editorRunJobs()) editorRefreshScreen();
+
+		// with no new keys the long edit gets its next slice, unless a lone escape is due to be decoded first
+		if(working && n == 0 && !(in->len && in->escdue && editorNow() >= in->escdue)) return WORK_EVENT;
+	}
+}
+
+// func to get the current position of  the cursor
+int getCursorPosition(int* rows, int* cols){
+	// character buffer to store the response of the current cursor position
+	char buffer[32];
+
+
+	unsigned int i = 0;
+	
+	// try to request the terminal for the current cursor position
+	if(write(STDOUT_FILENO, "\x1b[6n", 4) != 4) return -1;
+
+	// read the response sent by the terminal into the char buffer
+	while(i < sizeof(buffer) - 1){
+		if(read(STDIN_FILENO, &buffer[i], 1) != 1) break;
+		if(buffer[i] == 'R') break;
+		i++;
+	}
+	
+	// makes the character buffer into a string in C
+	buffer[i] = '\0';
 	
 	// check for valid cursor position
 	if(buffer[0] != '\x1b' || buffer[1] != '[') return -1;
@@ -367,80 +1616,202 @@ int editorRowRxToCx(erow* row, int rx){
 	return cx;
 }
 
-// func that converts tabs to spaces
-void editorUpdateRow(erow* row){
-	int tabs = 0;
-	for(int j = 0; j < row->size; j++){
-		if(row->text[j] == '\t') tabs++;
+// func to mix the hashes of two neighbouring rows into the term the pair adds to the hash of the buffer
+unsigned long long editorHashPair(unsigned long long a, unsigned long long b){
+	unsigned long long h = (a ^ (b >> 29) ^ (b << 35)) * 0xBF58476D1CE4E5B9ULL + b;
+	h ^= h >> 31;
+	return h * 0x94D049BB133111EBULL;
+}
+
+// func to get the hash of row j of the buffer, the rows past either end are fixed values so the first and last rows are hashed as such
+unsigned long long editorRowHashAt(int j){
+	if(j < 0) return YETI_HASH_FIRST;
+	if(j >= state.textrows) return YETI_HASH_LAST;
+	return state.row[j].hash;
+}
+
+// func to get what the rows [start, end) add to the hash of the buffer over the rows around them being neighbours, O(end - start)
+unsigned long long editorHashSpan(int start, int end){
+	unsigned long long before = editorRowHashAt(start - 1), after = editorRowHashAt(end);
+	unsigned long long sum = 0, prev = before;
+	for(int j = start; j < end; j++){
+		sum += editorHashPair(prev, state.row[j].hash);
+		prev = state.row[j].hash;
+	}
+	return sum + editorHashPair(prev, after) - editorHashPair(before, after);
+}
+
+// func to set the modified flag by comparing the text with the one last loaded or saved, the hashes of the rows are only compared one by one when the hashes of the buffers match
+void editorCheckModified(){
+	ebuf* b = &bl.buffers[bl.curr];
+	state.modified = state.hash != b->savedhash || state.textrows != b->savedn;
+
+	// moving a block between two copies of the same line keeps every neighbouring pair so it is only caught here
+	for(int j = 0; !state.modified && j < state.textrows; j++) state.modified = state.row[j].hash != b->savedrows[j];
+}
+
+// func to rebuild the hash of the buffer from the hashes of its rows, used after rows were moved around in bulk
+void editorRehash(){
+	state.hash = editorHashPair(YETI_HASH_FIRST, YETI_HASH_LAST) + editorHashSpan(0, state.textrows);
+	editorCheckModified();
+}
+
+// func to remember the text as the one on the disk
+void editorMarkSaved(){
+	ebuf* b = &bl.buffers[bl.curr];
+	b->savedrows = realloc(b->savedrows, sizeof(unsigned long long) * (state.textrows + 1));
+	for(int j = 0; j < state.textrows; j++) b->savedrows[j] = state.row[j].hash;
+	b->savedn = state.textrows;
+	b->savedhash = state.hash;
+	state.modified = 0;
+	state.edits = 0;
+}
+
+// func to let go of a line held by a row or version
+void editorLineRelease(struct editorLine* line){
+	if(line && __atomic_sub_fetch(&line->refs, 1, __ATOMIC_ACQ_REL) == 0) free(line);
+}
+
+// func to hash the text of a row, a row of the buffer also updates the hash of the buffer in O(1)
+void editorHashRow(erow* row){
+	// every change of the text comes through here, so the line handed out to versions is let go and the next version copies the text again
+	editorLineRelease(row->line);
+	row->line = NULL;
+
+	unsigned long long h = editorHashBytes(row->text, row->size);
+	if(state.row == NULL || row < state.row || row >= state.row + state.textrows){
+		row->hash = h;
+		return;
 	}
+
+	int at = row - state.row;
+	state.hash -= editorHashSpan(at, at + 1);
+	row->hash = h;
+	state.hash += editorHashSpan(at, at + 1);
+	editorCheckModified();
+}
+
+// func to build the render of a row from its text
+void editorRenderRow(erow* row){
+	// nothing is drawn in batch mode so the render is never built
+	if(batchmode) return;
+
+	int tabs = editorCountByte(row->text, row->size, '\t');
 	free(row->render);
 	row->render = malloc(row->size + tabs*(YETI_TAB_STOP-1) + 1);
 
-	int idx = 0;
-	for(int j = 0; j < row->size; j++){
-		if(row->text[j] == '\t'){
-			row->render[idx++] = ' ';
-			while(idx % YETI_TAB_STOP != 0) row->render[idx++] = ' ';
-		} else {
-			row->render[idx++] = row->text[j];
-		}
-	}
+	int idx = editorExpandTabs(row->text, row->size, row->render);
 	row->render[idx] = '\0';
 	row->rsize = idx;
 }
 
+// func that converts tabs to spaces
+void editorUpdateRow(erow* row){
+	// the hash is kept in batch mode too since the modified flag is worked out from it
+	editorHashRow(row);
+	editorRenderRow(row);
+}
+
 // func to append every new line read from the file to the state
 void editorInsertRow(int at, char *s, size_t len){
 	//if(at < 0 || at > state.textrows) return;
 	
-	// insert a new row
-	state.row = realloc(state.row, sizeof(erow) * (state.textrows+1));
-	memmove(&state.row[at+1], &state.row[at], sizeof(erow) * (state.textrows - at));
-	
-	// reallocate space to store the new line of text being read
-	state.row = realloc(state.row, sizeof(erow) * (state.textrows + 1));
-	
+	// the row is built before it is placed so its hash is only added to the buffer once
+	erow row;
+
 	// set the length of the text typed to the state
-	state.row[at].size = len;
+	row.size = len;
 
 	// allocate enough space to the pointer that is going to hold the text
-	state.row[at].text = malloc(len + 1);
+	row.text = malloc(len + 1);
 
 	// copy the text from the file to the state to display
-	memcpy(state.row[at].text, s, len);
+	memcpy(row.text, s, len);
 
 	// null end the text to make it a string
-	state.row[at].text[len] = '\0';
+	row.text[len] = '\0';
 
 	// actual text to be rendered
-	state.row[at].render = NULL;
+	row.render = NULL;
+	row.id = ++lastrowid;
+	row.line = NULL;
 
 	// size of the actual text to be rendered
-	state.row[at].rsize = 0;
+	row.rsize = 0;
 	
-	editorUpdateRow(&state.row[at]);
+	editorUpdateRow(&row);
+
+	// insert a new row
+	state.row = realloc(state.row, sizeof(erow) * (state.textrows+1));
+	memmove(&state.row[at+1], &state.row[at], sizeof(erow) * (state.textrows - at));
+	state.row[at] = row;
 
 	// update the no. of rows that contain text in the state
 	state.textrows++;
+	state.hash += editorHashSpan(at, at + 1);
 
 	// to show that the file was modified
-	state.modified++;
+	state.edits++;
+	editorCheckModified();
 }
 
-// func to free the passed line
+// func to free the passed line, the row of an undo state only lets go of the line its text lives in
 void editorFreeRow(erow* row){
 	free(row->render);
-	free(row->text);
+	if(row->line == NULL || row->text != row->line->text) free(row->text);
+	editorLineRelease(row->line);
 }
 
 // func to func to shift the text to replace the line 
 void editorDelRow(int at){
 	if(at < 0 || at >= state.textrows) return;
 
+	state.hash -= editorHashSpan(at, at + 1);
 	editorFreeRow(&state.row[at]);
 	memmove(&state.row[at], &state.row[at + 1], sizeof(erow) * (state.textrows - at -1));
 	state.textrows--;
-	state.modified++;
+	state.edits++;
+	editorCheckModified();
+}
+
+// func to replace the rows [start, end) with n already built rows, the old rows are freed and the new ones are moved in with a single shift of the rows after them
+void editorReplaceRows(int start, int end, erow* rows, int n){
+	state.hash -= editorHashSpan(start, end);
+	for(int j = start; j < end; j++) editorFreeRow(&state.row[j]);
+
+	int newrows = state.textrows - (end - start) + n;
+	if(n > end - start) state.row = realloc(state.row, sizeof(erow) * newrows);
+	memmove(&state.row[start + n], &state.row[end], sizeof(erow) * (state.textrows - end));
+	memcpy(&state.row[start], rows, sizeof(erow) * n);
+	state.textrows = newrows;
+	state.hash += editorHashSpan(start, start + n);
+	state.edits++;
+	editorCheckModified();
+}
+
+// func to get the length of the leading whitespace of a row
+int editorRowIndent(erow* row){
+	int n = 0;
+	while(n < row->size && (row->text[n] == ' ' || row->text[n] == '\t')) n++;
+	return n;
+}
+
+// func to shift the render of a row by the given no. of columns, used when only the leading whitespace changed and every tab stop after it moved by the same amount
+void editorRowShiftRender(erow* row, int shift){
+	// the text changed along with the render
+	editorHashRow(row);
+
+	// rows in batch mode have no render
+	if(row->render == NULL) return;
+
+	if(shift > 0){
+		row->render = realloc(row->render, row->rsize + shift + 1);
+		memmove(&row->render[shift], row->render, row->rsize + 1);
+		memset(row->render, ' ', shift);
+	} else {
+		memmove(row->render, &row->render[-shift], row->rsize + shift + 1);
+	}
+	row->rsize += shift;
 }
 
 // func to insert characters into a line 
@@ -459,7 +1830,7 @@ void editorRowInsertChar(erow* row, int at, int c){
 	row->size++;
 	row->text[at] = c;
 	editorUpdateRow(row);
-	state.modified++;
+	state.edits++;
 }
 
 // func to append the line when the use hits backspace to the previous line ending
@@ -474,7 +1845,7 @@ void editorRowAppendString(erow* row, char *s, size_t len){
 	row->size += len;
 	row->text[row->size] = '\0';
 	editorUpdateRow(row);
-	state.modified++;
+	state.edits++;
 }
 
 // func to delete a char 
@@ -485,11 +1856,19 @@ void editorRowDelChar(erow* row, int at){
 	memmove(&row->text[at], &row->text[at+1], row->size - at);
 	row->size--;
 	editorUpdateRow(row);
-	state.modified++;
+	state.edits++;
 }
 
 /***EDITOR OPERATIONS***/
 
+// func to keep the cursor on a valid position after rows were removed
+void editorClampCursor(){
+	if(state.cy >= state.textrows) state.cy = state.textrows - 1;
+	if(state.cy < 0) state.cy = 0;
+	int size = state.textrows ? state.row[state.cy].size : 0;
+	if(state.cx > size + state.linenooff) state.cx = size + state.linenooff;
+}
+
 // func to insert character
 void editorInsertChar(int c){
 	// if the cursor is on the last line that is of the editor that is blank, then we convert that into a text row 
@@ -502,11 +1881,14 @@ void editorInsertChar(int c){
 	state.cx++;
 	
 	// add the current state to undoRedo only if the use makes more than three cchanges or enters a space 
-	if(c == ' ' || (state.modified % 3 == 0)) editorAddState();
+	if(c == ' ' || (state.edits % 3 == 0)) editorAddState();
 }
 
 // func to add a new row
 void editorInsertNewLine(){
+	// stores the length of the indentation carried over to the new line
+	int indent = 0;
+
 	// if the cursor is in the beginning, it adds a new row and shifts the rest of the content
 	if(state.cx == state.linenooff) editorInsertRow(state.cy, "", 0);
 
@@ -514,9 +1896,21 @@ void editorInsertNewLine(){
 	else {
 		// get the current row
 		erow* row = &state.row[state.cy];
+		int at = state.cx - state.linenooff;
+
+		// with auto-indent the new line starts with the leading whitespace of the current one
+		if(opts.autoindent) indent = editorRowIndent(row);
+		if(indent > at) indent = at;
+
+		// build the text of the new line from the indentation and the text after the cursor
+		int restlen = row->size - at;
+		char* text = malloc(indent + restlen + 1);
+		memcpy(text, row->text, indent);
+		memcpy(&text[indent], &row->text[at], restlen);
 
 		// insert a new row after the current row
-		editorInsertRow(state.cy + 1, &row->text[state.cx - state.linenooff], (row->size) - (state.cx - state.linenooff));
+		editorInsertRow(state.cy + 1, text, indent + restlen);
+		free(text);
 
 		row = &state.row[state.cy];
 		
@@ -527,7 +1921,7 @@ void editorInsertNewLine(){
 	}
 	// update state
 	state.cy++;
-	state.cx = state.linenooff;
+	state.cx = state.linenooff + indent;
 }
 
 // func to delete char
@@ -554,719 +1948,5062 @@ void editorDelChar(){
 		state.cy--;
 	}
 
-	if(state.modified % 3 == 0) editorAddState();
+	if(state.edits % 3 == 0) editorAddState();
 }
 
 
-/***FILE I/O***/
-
-// func converts the rows in the state to a string to be written to the file
-char* editorRowsToString(int* buflen){
-	// stores the total length of text in our state
-	int totlen = 0;
+/***BUFFERS***/
 
-	// calculate the total length and save it in buflen
-	for(int j=0; j < state.textrows; j++) totlen += state.row[j].size + 1;
-	*buflen = totlen;
+// func to reset state and ur to an empty buffer, the screen size and terminal attributes are left alone
+void editorInitBuffer(){
+	// initial cursor position
+	state.cx = 0;
+	state.cy = 0;
+	state.rx = 0;
 	
-	// buffer to point to the beginning of the string
-	char* buffer = malloc(totlen);
+	// initial no of rows containing text
+	state.textrows = 0;
 
-	//used to help create the string
-	char* p = buffer;
+	// initial text
+	state.row = NULL;
 
-	// copy the text from each line and save it to the newly al;located memory and also ending each line with a newline character
-	for(int j=0; j < state.textrows; j++){
-		memcpy(p, state.row[j].text, state.row[j].size);
-		p += state.row[j].size;
-		*p = '\n';
-		p++;
-	}
-	return buffer;
-}
+	// intial topmost row present on the visible screen
+	state.rowoff = 0;
 
-// func to read the file passed to be read into the editor
-void editorOpen(char *filename){
-	// clear previous filename held
-	free(state.filename);
+	// initial leftmost col visible on the scrrrn
+	state.coloff = 0;
 
-	// automatically allocates and stores the filename
-	state.filename = strdup(filename);
+	// initially no status message
+	state.statusmsg[0] = '\0';
 
-	// opening file to read contents
-	FILE *fp = fopen(filename, "r");
-	
-	// if the  file could not be opened throw an error
-	if(!fp) die("fopen");
+	// initial modified value
+	state.modified = 0;
+	state.edits = 0;
+
+	// the empty text is the one on the disk until the buffer is loaded
+	state.hash = editorHashPair(YETI_HASH_FIRST, YETI_HASH_LAST);
+	bl.buffers[bl.curr].savedhash = state.hash;
+	bl.buffers[bl.curr].savedrows = NULL;
+	bl.buffers[bl.curr].savedn = 0;
+	for(int j = 0; j < YETI_MARKS; j++) bl.buffers[bl.curr].marks[j].id = 0;
+	bl.buffers[bl.curr].diff = NULL;
 	
-	// stores the line read from the file
-	char *line = NULL;
+	// iniial lineno offset value
+	state.linenooff = 0;
 
-	// used to store the memory allocated to the store the line
-	size_t linecap = 0;
+	// initial undo-redo value
+	ur.states = NULL;
 
-	// store the length of the line read
-	ssize_t linelen;
+	// assign the clone function to the undo-redo variable
+	ur.clone = cloneState;
 	
-	// if there is text in that line
-	while((linelen = getline(&line, &linecap, fp)) != -1){
-		// removes the newline character since our struct erow anyways points to a single line always
-		while(linelen > 0  && (line[linelen-1] == '\n' || line[linelen-1] == '\r')) linelen--;
-		editorInsertRow(state.textrows, line , linelen);	
-	}
-	free(line);
-	fclose(fp);
+	// initial state index in the undo functionalitya
+	ur.size = 0;
+	ur.currStateIndex = 0;
 
-	// we reset the moodified state since there was no change made while reading the file
-	state.modified = 0;
-	editorAddState();
+	// no file yet
+	state.filename = NULL;
+	state.compress = COMPRESS_NONE;
+	bl.buffers[bl.curr].unloaded = 0;
 }
 
-// func to save the string to the file 
-void editorSave(){
-	// todo for new file
-	if(state.filename == NULL){
-		state.filename = editorPrompt("Save as: %s (ESC to cancel)", NULL);
+// func to free the text of a state
+void editorFreeState(struct editorConfig* s){
+	for(int j = 0; j < s->textrows; j++) editorFreeRow(&s->row[j]);
+	free(s->row);
+	free(s->filename);
+	s->row = NULL;
+	s->filename = NULL;
+	s->textrows = 0;
+}
 
-		// if the user pressed escape
-		if(state.filename == NULL){
-			editorSetStatusMessage("Save aborted");
-			return;
-		}
-	}
+// func to copy the buffer being edited back into its slot
+void editorStashBuffer(){
+	bl.buffers[bl.curr].state = state;
+	bl.buffers[bl.curr].ur = ur;
+}
 
-	// stores the length of the string created
-	int len;
+// func to make another buffer the one being edited, only the structs are swapped so nothing is reloaded
+void editorSwitchBuffer(int n){
+	if(n < 0 || n >= bl.size || n == bl.curr) return;
 
-	//stores the string returned from the function that is thee entire updated text
-	char* buffer = editorRowsToString(&len);
+	editorStashBuffer();
 
-	// open the file to save the changes with the appropriate permissions
-	int fd = open(state.filename, O_RDWR | O_CREAT, 0644);
-	
-	if(fd != -1){
-		// sets the file size to the specified length
-		if(ftruncate(fd, len) != -1){
-			// write the new text to the file
-			if(write(fd, buffer, len) == len){
-				// close the file
-				close(fd);
+	// the screen belongs to the editor and not to the buffer, so does the status message as there is one timer clearing it
+	int screenrows = state.screenrows;
+	int screencols = state.screencols;
+	struct termios orig = state.orig;
+	char statusmsg[sizeof(state.statusmsg)];
+	strcpy(statusmsg, state.statusmsg);
 
-				// free the memory allocated for the buffer since the wrtitng is done
-				free(buffer);
-				
-				// on saving we reset modified since the file on the disk and in file editor are the same
-				state.modified = 0;
-
-				// set status meeesage
-				editorSetStatusMessage("%d bytes written to disk", len);
-				
-				// update the states array to hold only thwe current state since the file was saved
-				editorResizeUR(1);
-				ur.size = 0;
-				ur.currStateIndex = 0;
-
-				// add it to the undoRedo state
-				editorAddState();
-				return;
-			}
-		}
+	state = bl.buffers[n].state;
+	ur = bl.buffers[n].ur;
+	bl.curr = n;
 
-		close(fd);
-	}
+	state.screenrows = screenrows;
+	state.screencols = screencols;
+	state.orig = orig;
+	strcpy(state.statusmsg, statusmsg);
 
-	free(buffer);
-	
-	// set status message
-	editorSetStatusMessage("Can't save! I/O error: %s", strerror(errno));
+	// a buffer restored from a session is read the first time it is shown
+	if(bl.buffers[n].unloaded) editorLoadBuffer();
 }
 
-/***QUIT***/
+// func to add an empty buffer and switch to it, returns its index
+int editorNewBuffer(){
+	editorStashBuffer();
 
-// funcc to tell the terminal to clear the screen and postion the cursor to the top-left
-void editorQuit(){	
-	write(STDOUT_FILENO, "\x1b[2J", 4);
-	write(STDOUT_FILENO, "\x1b[H", 3);
-	exit(0);
+	bl.buffers = realloc(bl.buffers, sizeof(ebuf) * (bl.size + 1));
+	bl.curr = bl.size++;
+	editorInitBuffer();
+	return bl.curr;
 }
 
-/***UNDO***/
-
-// func to handle the undo feature
-void editorUndoState(){
-	// if the current state is the same as the fiel saaved to disk , we donot undo
-	if(ur.currStateIndex > 0) ur.currStateIndex -= 1;
-	
-	// showws a message if the current state is the same as the file saved to disk
-	if(ur.currStateIndex < 0 || (ur.currStateIndex == 0 && state.modified == 0)){
-		ur.currStateIndex = 0;
-		editorSetStatusMessage("Current file matches with the file on the disk");
-		return;
-	}  
-	
-	// reduce the states stored on every undo
-	if(ur.size != 1) {
-		ur.size -= 1;
-		editorResizeUR(ur.size);
+// func to close the buffer being edited, the last buffer can not be closed
+int editorCloseBuffer(){
+	if(bl.size == 1){
+		editorSetStatusMessage("Can't close the last buffer");
+		return -1;
 	}
-	
-	// update the state according to the current undo index
-	state = *ur.clone(&ur.states[ur.currStateIndex]);
-	editorSetStatusMessage("Undo successfull!");
-	editorRefreshScreen();
+	if(state.modified){
+		editorSetStatusMessage("Unsaved file changes! Save the buffer before closing it");
+		return -1;
+	}
+
+	// free the text and every undo state of the buffer, a diff still on the pool is cancelled
+	int closed = bl.curr;
+	if(bl.buffers[closed].diff) editorPoolCancel(bl.buffers[closed].diff);
+	free(bl.buffers[closed].savedrows);
+	editorFreeState(&state);
+	for(int j = 0; j < ur.size; j++) editorFreeState(&ur.states[j]);
+	free(ur.states);
+
+	// the buffer after it (or before it if it was the last one) is shown next
+	int next = closed < bl.size - 1 ? closed + 1 : closed - 1;
+	editorSwitchBuffer(next);
+	memmove(&bl.buffers[closed], &bl.buffers[closed + 1], sizeof(ebuf) * (bl.size - closed - 1));
+	bl.size--;
+	if(bl.curr > closed) bl.curr--;
+	editorWindowsBufferClosed(closed);
+	editorJumpsBufferClosed(closed);
+	editorJobsBufferClosed(closed);
+
+	editorSetStatusMessage("[%d/%d] %s", bl.curr + 1, bl.size, state.filename ? state.filename : "[No Name]");
+	return 0;
 }
 
-/***FIND***/
+// func to get the state of a buffer whether or not it is the one being edited
+struct editorConfig* editorBufferState(int n){
+	return n == bl.curr ? &state : &bl.buffers[n].state;
+}
 
-void editorFindCallback(char* query, int key){
-	// static variables that maintain the last search positions
-	static int last_match = -1;
-	static int direction = 1;
-	
-	// move the cursor to the next or previous match
-	if(key == '\r' || key == '\x1b'){
-		last_match = -1;
-		direction = 1;
-		return;
-	} else if(key == ARROW_RIGHT || key == ARROW_DOWN) direction = 1;
+// func to find the buffer that holds the given file, returns -1 if it is not open
+int editorFindBuffer(const char* filename){
+	char* path = realpath(filename, NULL);
+	if(path == NULL) return -1;
 
-	else if(key == ARROW_LEFT || key == ARROW_UP) direction = -1;
-	
-	// reset the variables for the next search
-	else{
-		last_match = -1;
-		direction = 1;
-	}
+	int found = -1;
+	for(int j = 0; j < bl.size && found == -1; j++){
+		struct editorConfig* s = editorBufferState(j);
+		if(s->filename == NULL) continue;
 
-	if(last_match == -1) direction = 1;
-	int current  = last_match;
+		char* other = realpath(s->filename, NULL);
+		if(other && strcmp(path, other) == 0) found = j;
+		free(other);
+	}
 
-	// loop to search the query
-	for(int i = 0; i < state.textrows; i++){
-		current += direction;
-		if(current == -1) current = state.textrows - 1;
-		else if(current == state.textrows) current = 0;
-		erow* row = &state.row[current];
-		
-		// checks if the query is a sssubstring of the current row
-		char* match = strstr(row->render, query);
+	free(path);
+	return found;
+}
 
-		// if it is a substring
-		if(match) {
-			last_match = current;
+// func to check if any open buffer has unsaved changes, returns its index or -1
+int editorModifiedBuffer(){
+	for(int j = 0; j < bl.size; j++){
+		if(editorBufferState(j)->modified) return j;
+	}
+	return -1;
+}
 
-			// update the state
-			state.cy = current;
-			state.cx = editorRowRxToCx(row, match - row->render) + state.linenooff;
-			state.rowoff = state.textrows;
-			break;
-		}
+// func to switch to a buffer by its index, returns -1 if there is no such buffer
+int editorGotoBuffer(int n){
+	if(n < 0 || n >= bl.size){
+		editorSetStatusMessage("No buffer %d", n + 1);
+		return -1;
 	}
+	if(n != bl.curr) editorJumpPush(state.cy, state.cx);
+	editorSwitchBuffer(n);
+	editorSetStatusMessage("[%d/%d] %s", n + 1, bl.size, state.filename ? state.filename : "[No Name]");
+	return 0;
+}
 
+// func to list the open buffers in the status message
+void editorListBuffers(){
+	char list[sizeof(state.statusmsg)];
+	int len = 0;
+	for(int j = 0; j < bl.size && len < (int)sizeof(list); j++){
+		struct editorConfig* s = editorBufferState(j);
+		len += snprintf(&list[len], sizeof(list) - len, "%s%d:%s%s%s", j ? " " : "", j + 1, j == bl.curr ? "[" : "", s->filename ? s->filename : "[No Name]", j == bl.curr ? "]" : "");
+	}
+	editorSetStatusMessage("%s", list);
 }
 
-// func for searching
-void editorFind(){
-	
-	// save the initial state before searching
-	int saved_cx = state.cx;
-	int saved_cy = state.cy;
-	int saved_coloff = state.coloff;
-	int saved_rowoff = state.rowoff;
+// struct to hold the rows of a buffer as they were at one point, it never changes so any thread holding it can read it without locks while the buffer is edited
+struct editorVersion{
+	int refs; // no. of holders, only changed with atomic builtins
+	int n; // no. of lines
+	struct editorLine** lines; // the lines in order
+};
 
-	// get the query typed by the user
-	char* query = editorPrompt("Search: %s (ESC to cancel)", editorFindCallback);
-	
-	// free space once the user exits the search
-	if(query) free(query);
-	
-	// when the user exits search mode, we return the cursor to the original position
-	else {
-		state.cx = saved_cx;
-		state.cy = saved_cy;
-		state.coloff = saved_coloff;
-		state.rowoff = saved_rowoff;
+// func to take a version of the rows [start, end) of the buffer being edited, only the rows that changed since the last version are copied and the rest are shared with it
+struct editorVersion* editorVersionTake(int start, int end){
+	struct editorVersion* v = malloc(sizeof(struct editorVersion));
+	v->refs = 1;
+	v->n = end - start;
+	v->lines = malloc(sizeof(struct editorLine*) * (v->n + 1));
+
+	for(int j = 0; j < v->n; j++){
+		erow* row = &state.row[start + j];
+
+		// a row whose text changed let go of its line, so a line still held is the text as it is
+		v->lines[j] = editorRowLine(row);
+		__atomic_add_fetch(&v->lines[j]->refs, 1, __ATOMIC_RELAXED);
 	}
+	return v;
+}
 
+// func to hold on to a version
+struct editorVersion* editorVersionRetain(struct editorVersion* v){
+	__atomic_add_fetch(&v->refs, 1, __ATOMIC_RELAXED);
+	return v;
 }
 
-/***APPEND BUFFER***/
+// func to let go of a version, the last holder frees it
+void editorVersionRelease(struct editorVersion* v){
+	if(v == NULL || __atomic_sub_fetch(&v->refs, 1, __ATOMIC_ACQ_REL)) return;
+	for(int j = 0; j < v->n; j++) editorLineRelease(v->lines[j]);
+	free(v->lines);
+	free(v);
+}
 
-// struct to hold data about the buffer
-struct append_buffer{
-	char* b; // stores the text
-	int len; // stores the length of the string
-};
+/***WINDOWS***/
 
-#define APPENDBUF_INIT {NULL, 0} // macro constructor to initialize a new append buffer
+// func to free what a screen remembers of the last frame
+void editorFreeFrame(windowList* l){
+	for(int j = 0; j < l->size; j++){
+		ewin* w = &l->wins[j];
+		if(w->lines){
+			for(int y = 0; y < w->rows; y++) free(w->lines[y]);
+		}
+		free(w->lines);
+		free(w->lens);
+		w->lines = NULL;
+		w->lens = NULL;
+	}
+	free(l->msgline);
+	l->msgline = NULL;
+	l->msglen = -1;
+}
 
-// func to append a new string to the buffer
-void appBuffAppend(struct append_buffer* ab, const char* s, int len){
-	// realloc more memory to the current string to be able to append the new string to it
-	char* new = (char*)realloc(ab->b, ab->len + len);
-	
-	// if the reallocation was not possible
-	if(new == NULL) return;
+// func to forget the output a screen did not take, the terminal may be left inside an escape sequence so the next frame has to start over
+void editorDropOutput(windowList* l){
+	free(l->out.b);
+	l->out.b = NULL;
+	l->out.len = 0;
+	l->out.sent = 0;
+}
 
-	// copies the string to be appended to the newly allocated memory
-	memcpy(&new[ab->len], s, len);
-	
-	// update the current buffer with the newly appended pointer and len
-	ab->b = new;
-	ab->len += len;
+// func to forget what was drawn so the next refresh redraws the whole screen
+void editorInvalidateFrame(){
+	editorFreeFrame(&wl);
 }
 
-// func to free the current buffer
-void appBuffFree(struct append_buffer* ab){
-	free(ab->b);
+// func to copy the cursor and view of the buffer being edited into the active window
+void editorSaveWindow(){
+	ewin* w = &wl.wins[wl.curr];
+	w->buf = bl.curr;
+	w->cx = state.cx;
+	w->cy = state.cy;
+	w->rx = state.rx;
+	w->rowoff = state.rowoff;
+	w->coloff = state.coloff;
 }
 
-/***OUTPUT***/
+// func to make the buffer, cursor, view and size of the active window the ones being edited
+void editorLoadWindow(){
+	ewin* w = &wl.wins[wl.curr];
+	editorSwitchBuffer(w->buf);
+
+	state.cx = w->cx;
+	state.cy = w->cy;
+	state.rx = w->rx;
+	state.rowoff = w->rowoff;
+	state.coloff = w->coloff;
+	state.screenrows = w->rows - 1;
+	state.screencols = w->cols;
+
+	// the text may have changed through another window
+	editorClampCursor();
+}
 
-// handles scrolling 
-void editorScroll(){
+// func to set up a screen of the given size covered by a single window showing the buffer being edited
+void editorInitWindows(int rows, int cols, int infd, int outfd){
+	wl.wins = calloc(1, sizeof(ewin));
+	wl.size = 1;
+	wl.curr = 0;
+	wl.screenrows = rows;
+	wl.screencols = cols;
+	wl.msgline = NULL;
+	wl.msglen = -1;
+	wl.infd = infd;
+	wl.outfd = outfd;
+	wl.in.head = 0;
+	wl.in.len = 0;
+	wl.in.escdue = 0;
+	wl.in.nheld = 0;
+	wl.out.b = NULL;
+	wl.out.len = 0;
+	wl.out.sent = 0;
+
+	// the window covers the screen except for the message bar
+	wl.wins[0].buf = bl.curr;
+	wl.wins[0].rows = rows - 1;
+	wl.wins[0].cols = cols;
+
+	// it starts where the cursor of the buffer is
+	editorSaveWindow();
+	state.screenrows = rows - 2;
+	state.screencols = cols;
+}
 
-	state.rx = 0;
+// func to make the next window the active one
+void editorNextWindow(){
+	if(wl.size == 1) return;
+	editorSaveWindow();
+	wl.curr = (wl.curr + 1) % wl.size;
+	editorLoadWindow();
+}
 
-	// as long as the cursor is on a text line, call the convert function
-	if(state.cy < state.textrows) state.rx = editorRowCxToRx(&state.row[state.cy], state.cx);
+// func to split the active window in two halves (side by side when vertical is set) showing the same buffer, the new half becomes active
+int editorSplitWindow(int vertical){
+	editorSaveWindow();
+	ewin* w = &wl.wins[wl.curr];
 
-	// if the cursor is above the visible screen, the editor scrolls up to the cursor position 
-	if(state.cy < state.rowoff) state.rowoff = state.cy;
-	
-	// if the cursor is at the bottom of the screen, the editor is scrolled down depending on the difference between cy and screenrows and we add once since the y in editorDraw loop starts off with 0
-	if(state.cy >= state.rowoff + state.screenrows) state.rowoff = (state.cy - state.screenrows) + 1;
-	
-	// same thing as above but for the horizontal scrolling
-	if(state.rx < state.coloff + state.linenooff) {
-		state.coloff = state.rx - state.linenooff;
+	// both halves need room for some text and a status bar
+	if((vertical && w->cols < 21) || (!vertical && w->rows < 6)){
+		editorSetStatusMessage("Not enough room to split");
+		return -1;
 	}
-	if(state.rx >= state.coloff + state.screencols) state.coloff = (state.rx - state.screencols) + 1;
-}
 
-// func to draw dash to the  begiinig of each row
-void editorDrawRows(struct append_buffer* ab){
-	for(int y=0; y < state.screenrows; y++){
-		// used to display the  correct range of lines based on the scroll position
-		int filerow = y + state.rowoff;
+	editorInvalidateFrame();
 
-		// if file row happens to be greater than the number of text lines present then we just print the dash to the editor
-		if(filerow >= state.textrows){
-			// writing the version of the editor one-third below the top only when there is no text present in the file supplied to the editor 
-			if(state.row[0].size == 0 && y == state.screenrows / 3){
-				// stores the text to be printed
-				char welcome[80];
-			
-				// store a specific format of the text into the variable
-				int welcomelen = snprintf(welcome, sizeof(welcome), "Yeti ---> version %s", YETI_VERSION);
-				// reducing the text if the terminal screen has less width
-				if(welcomelen > state.screencols) welcomelen = state.screencols;
-
-				// centering the text
-				int padding = (state.screencols - welcomelen) / 2;
-				if (padding){
-					appBuffAppend(ab, "-", 1);
-					padding--;
-				}
-				while(padding--)appBuffAppend(ab, " ", 1);
+	ewin nw = *w;
+	if(vertical){
+		int cols = w->cols;
+		w->cols = (cols - 1) / 2;
+		nw.left = w->left + w->cols + 1;
+		nw.cols = cols - w->cols - 1;
+	} else {
+		int rows = w->rows;
+		w->rows = rows / 2;
+		nw.top = w->top + w->rows;
+		nw.rows = rows - w->rows;
+	}
 
-				// write the text to the buffer 
-				appBuffAppend(ab, welcome, welcomelen);
-			} else {
-				//append to the buffer the dashes to be drawn
-				appBuffAppend(ab, "-", 1);
+	wl.wins = realloc(wl.wins, sizeof(ewin) * (wl.size + 1));
+	wl.wins[wl.size] = nw;
+	wl.curr = wl.size++;
+	editorLoadWindow();
+	return 0;
+}
+
+// func to grow the windows along one side (0 left, 1 right, 2 above, 3 below) of window n over it, returns the index of one of them or -1 if they do not exactly cover that side
+int editorGrowInto(int n, int side){
+	ewin* w = &wl.wins[n];
+
+	// the first pass checks that the neighbours on that side line up with the window and the second one grows them
+	int covered = 0;
+	for(int pass = 0; pass < 2; pass++){
+		int first = -1;
+		for(int j = 0; j < wl.size; j++){
+			if(j == n) continue;
+			ewin* x = &wl.wins[j];
+
+			int inrows = x->top >= w->top && x->top + x->rows <= w->top + w->rows;
+			int incols = x->left >= w->left && x->left + x->cols <= w->left + w->cols;
+			int adjacent = 0;
+			switch(side){
+				case 0: adjacent = inrows && x->left + x->cols + 1 == w->left; break;
+				case 1: adjacent = inrows && x->left == w->left + w->cols + 1; break;
+				case 2: adjacent = incols && x->top + x->rows == w->top; break;
+				case 3: adjacent = incols && x->top == w->top + w->rows; break;
+			}
+			if(!adjacent) continue;
+
+			if(pass == 0){
+				covered += side < 2 ? x->rows : x->cols + 1;
+				continue;
 			}
-		} else {
-			// get the size of the text to be written to the editor
-			int len = state.row[filerow].rsize - state.coloff;
-			
-			// if there is no text, then we do not write anything to the screen
-			if(len < 0) len = 0;
 
-			// buffer to print the line no
-			char lineno[80];
+			switch(side){
+				case 0: x->cols += w->cols + 1; break;
+				case 1: x->left = w->left; x->cols += w->cols + 1; break;
+				case 2: x->rows += w->rows; break;
+				case 3: x->top = w->top; x->rows += w->rows; break;
+			}
+			if(first == -1) first = j;
+		}
 
-			// holds th length of the current line no
-			int filerowLen = calculateDigits(filerow+1);
+		if(pass == 0 && covered != (side < 2 ? w->rows : w->cols + 1)) return -1;
+		if(pass == 1) return first;
+	}
+	return -1;
+}
 
-			// holds the length of the max line no for the current file
-			int maxLen = calculateDigits(state.textrows);
+// func to close the active window and give its space to its neighbours
+int editorCloseWindow(){
+	if(wl.size == 1){
+		editorSetStatusMessage("Can't close the last window");
+		return -1;
+	}
 
-			// holds the diff in lengths
-			int diff = maxLen - filerowLen;
+	editorSaveWindow();
+	editorInvalidateFrame();
 
-			// save the width taken by the line no col to state
-			state.linenooff = maxLen + 1;
+	int next = -1;
+	for(int side = 0; side < 4 && next == -1; side++) next = editorGrowInto(wl.curr, side);
+	if(next == -1){
+		editorSetStatusMessage("Can't close this window");
+		return -1;
+	}
 
-			// if the size of the text is bigger than that of the editor, we  only show the  text that can be accomodated
-			if(len + state.linenooff > state.screencols) len = state.screencols - state.linenooff;
-			// holds the padding required for the line nos to line up properly
-			char* spacebuf = malloc(sizeof(char)*(diff + 1));
-			char* temp = spacebuf;
-			while (diff){
-				*temp = ' ';
-				temp++;
-				diff--;
+	memmove(&wl.wins[wl.curr], &wl.wins[wl.curr + 1], sizeof(ewin) * (wl.size - wl.curr - 1));
+	wl.size--;
+	if(next > wl.curr) next--;
+	wl.curr = next;
+	editorLoadWindow();
+	return 0;
+}
 
-			}
-			*temp = '\0';
-			int linelen = snprintf(lineno, sizeof(lineno), "%s\033[1;36m%d\033[0m ", spacebuf, filerow+1);
-			free(spacebuf);
+// func to split the active window and open a file in the new half
+int editorSplitCommand(int vertical, const char* filename){
+	if(editorSplitWindow(vertical) == -1) return -1;
+	if(*filename && editorOpen((char*)filename) == -1) return -1;
+	return 0;
+}
 
-			// appending the line no to be printed
-			appBuffAppend(ab, lineno, linelen);
+// func to fix up the windows of a screen after a buffer was closed, the ones that showed it show the buffer being edited
+void editorFixWindows(windowList* l, int closed){
+	for(int j = 0; j < l->size; j++){
+		if(l->wins[j].buf == closed) l->wins[j].buf = bl.curr;
+		else if(l->wins[j].buf > closed) l->wins[j].buf--;
+	}
+}
 
+// func to fix up the windows of every screen after a buffer was closed
+void editorWindowsBufferClosed(int closed){
+	editorFixWindows(&wl, closed);
 
-			// appending the text to the append buffer that is used to write to the screen
-			appBuffAppend(ab, &state.row[filerow].render[state.coloff], len);
-		}
-	
-		// clear the line to the right once the dash is drawn
-		appBuffAppend(ab, "\x1b[K" , 3);
-		
-		// append to the buffer the newline characters
-		appBuffAppend(ab, "\r\n", 2);
+	// the windows of the other clients of a server are stored with them
+	for(int j = 0; j < cl.size; j++){
+		if(j != cl.curr) editorFixWindows(&cl.clients[j].wl, closed);
 	}
 }
 
-// func to draw the status bar
-void editorDrawStatusBar(struct append_buffer* ab){
-	// this tells the terminal to invert the colors attribute to the text written after this call
-	appBuffAppend(ab, "\x1b[7m",  4);
+/***FILE I/O***/
 
-	// state buffer to store the filename if it exists and rstatus to show the current cursor line and the modifed buffer to show the  number of lines modified 
-	char modified[30], status[80], rstatus[80];
+// func converts the rows in the state to a string to be written to the file
+char* editorRowsToString(int* buflen){
+	// stores the total length of text in our state
+	int totlen = 0;
 
-	snprintf(modified, sizeof(modified), "(%d modifications)", state.modified);
+	// calculate the total length and save it in buflen
+	for(int j=0; j < state.textrows; j++) totlen += state.row[j].size + 1;
+	*buflen = totlen;
+	
+	// buffer to point to the beginning of the string
+	char* buffer = malloc(totlen);
 
-	int len = snprintf(status, sizeof(status), "%.20s - %d lines %s", state.filename ? state.filename : "[No Name]", state.textrows, state.modified ? modified : "");
-	int rlen = snprintf(rstatus, sizeof(rstatus), "%d/%d", state.cx - state.linenooff + 1 > 0 ? state.cx - state.linenooff + 1 : 1, state.row[state.cy].size);
-	if(len > state.screencols) len = state.screenrows;
-	appBuffAppend(ab, status, len);
+	//used to help create the string
+	char* p = buffer;
 
-	// write spaces so the entire status bar turns white
-	while(len < state.screencols){
-		// write the current cursor line to the end of the status bar
-		if(state.screencols - len == rlen){
-			appBuffAppend(ab, rstatus, rlen);
-			break;
-		} else {
-			appBuffAppend(ab, " ", 1);
-			len++;
-		}
+	// copy the text from each line and save it to the newly al;located memory and also ending each line with a newline character
+	for(int j=0; j < state.textrows; j++){
+		memcpy(p, state.row[j].text, state.row[j].size);
+		p += state.row[j].size;
+		*p = '\n';
+		p++;
 	}
-	appBuffAppend(ab, "\x1b[m", 3);
-	appBuffAppend(ab, "\r\n", 2);
+	return buffer;
 }
 
-// writes the status message to the append buffer which lateer writes it to the screen
-void editorDrawMessageBar(struct append_buffer* ab){
-	// clears the previous status message
-	appBuffAppend(ab, "\x1b[K", 3);
-	
-	// store the length of the status message
-	int msglen = strlen(state.statusmsg);
+// func run by each thread to build the renders of its share of freshly read rows
+void editorRenderRowsWorker(int lo, int hi, void* arg){
+	erow* rows = arg;
+	for(int j = lo; j < hi; j++) editorUpdateRow(&rows[j]);
+}
 
-	// adjust the length of the status message incase it is bigger than the editor
-	if(msglen > state.screencols) msglen = state.screencols;
+// func to append the lines of a file held in memory to the buffer being edited, the rows are allocated in one go and their renders are built in parallel
+void editorLoadRows(const char* text, int len){
+	// a last line without a newline still counts
+	int lines = editorCountByte(text, len, '\n');
+	if(len && text[len - 1] != '\n') lines++;
+
+	state.row = realloc(state.row, sizeof(erow) * (state.textrows + lines));
+	erow* rows = &state.row[state.textrows];
+
+	const char* p = text;
+	const char* end = text + len;
+	for(int j = 0; j < lines; j++){
+		const char* nl = memchr(p, '\n', end - p);
+		if(nl == NULL) nl = end;
+
+		// removes the carriage returns of dos line endings
+		int linelen = nl - p;
+		while(linelen > 0 && p[linelen - 1] == '\r') linelen--;
+
+		rows[j].size = linelen;
+		rows[j].text = malloc(linelen + 1);
+		memcpy(rows[j].text, p, linelen);
+		rows[j].text[linelen] = '\0';
+		rows[j].render = NULL;
+		rows[j].rsize = 0;
+		rows[j].id = ++lastrowid;
+		rows[j].line = NULL;
+		p = nl + 1;
+	}
 
-	// we write the status message to the screen only if it has some text and the status message was not older than 5 seconds
-	if(msglen && time(NULL) - state.statusmsg_time < 5) appBuffAppend(ab, state.statusmsg, msglen);
+	editorParallelFor(lines, YETI_PARALLEL_MIN_ROWS, editorRenderRowsWorker, rows);
+	state.textrows += lines;
+	state.hash += editorHashSpan(state.textrows - lines, state.textrows);
+	state.edits += lines;
+	editorCheckModified();
 }
 
-// func to clear the screen
-void editorRefreshScreen(){
-	// func to handle scrolling
-	editorScroll();
-
-	// initialize an empty append buffer
-	struct append_buffer ab = APPENDBUF_INIT;
+// func to get a buffer for a file, the current one is reused if it is still the untouched empty one the editor started with, else a new one is made
+void editorTakeBuffer(){
+	if(state.filename == NULL && state.modified == 0 && state.edits == 0 && state.textrows <= 1 && (state.textrows == 0 || state.row[0].size == 0)){
+		editorFreeState(&state);
+		for(int j = 0; j < ur.size; j++) editorFreeState(&ur.states[j]);
+		free(ur.states);
+		free(bl.buffers[bl.curr].savedrows);
+		editorInitBuffer();
+	} else {
+		editorNewBuffer();
+	}
+}
 
-	// hide cursor while re drawing to the screen
-	appBuffAppend(&ab, "\x1b[?25l", 6);
+// func to find the format of a file from its magic bytes
+enum editorCompression editorDetectCompression(int fd){
+	char magic[8];
+	ssize_t n = pread(fd, magic, sizeof(magic), 0);
+	for(int j = COMPRESS_NONE + 1; j < (int)(sizeof(codecs) / sizeof(codecs[0])); j++){
+		if(n >= codecs[j].magiclen && memcmp(magic, codecs[j].magic, codecs[j].magiclen) == 0) return j;
+	}
+	return COMPRESS_NONE;
+}
 
-	// tells the terminal to position the cursor at row:1 and col:1 (i.e top-left)
-	appBuffAppend(&ab, "\x1b[H", 3);
+// func to read the lines of an open file into the buffer being edited and close it
+void editorReadRows(FILE* fp){
+	// compressed files are read through their decompressor
+	state.compress = editorDetectCompression(fileno(fp));
+
+	// regular files are mapped and split in place, anything else is read line by line
+	struct stat st;
+	char* map = MAP_FAILED;
+	int damaged = 0;
+	if(state.compress != COMPRESS_NONE) damaged = editorReadCompressedRows(fp) == -1;
+	else if(fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size < INT_MAX) map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+	if(map != MAP_FAILED){
+		editorLoadRows(map, (int)st.st_size);
+		munmap(map, st.st_size);
+	} else if(state.compress == COMPRESS_NONE){
+		// stores the line read from the file
+		char *line = NULL;
+
+		// used to store the memory allocated to the store the line
+		size_t linecap = 0;
+
+		// store the length of the line read
+		ssize_t linelen;
+		
+		// if there is text in that line
+		while((linelen = getline(&line, &linecap, fp)) != -1){
+			// removes the newline character since our struct erow anyways points to a single line always
+			while(linelen > 0  && (line[linelen-1] == '\n' || line[linelen-1] == '\r')) linelen--;
+			editorInsertRow(state.textrows, line , linelen);	
+		}
+		free(line);
+	}
+	fclose(fp);
 
-	// call func to write dashes to the buffer
-	editorDrawRows(&ab);
-	
-	// call func to write the status bar to the screen
-	editorDrawStatusBar(&ab);
+	// the editor always holds at least one row
+	if(state.textrows == 0) editorInsertRow(0, "", 0);
 
-	// call func to write the status message
-	editorDrawMessageBar(&ab);
-	
-	// buffer to store the position of the cursor in a specific format
-	char buffer[32];
-	
-	if(state.cx < state.linenooff && state.rx < state.linenooff){
-		state.cx = state.linenooff;
-		state.rx = state.linenooff;
+	// we reset the moodified state since there was no change made while reading the file, unless it could not all be read
+	editorMarkSaved();
+	if(damaged){
+		bl.buffers[bl.curr].savedn = -1;
+		state.modified = 1;
 	}
+	editorAddState();
+}
 
-	// store the position of the cursor in the required format
-	snprintf(buffer, sizeof(buffer), "\x1b[%d;%dH", (state.cy - state.rowoff) + 1, (state.rx - state.coloff) + 1);
+// func to put the cursor and view of the buffer being edited where they were saved, they are kept inside the text since the file may have changed since
+void editorRestoreView(int cy, int col, int rowoff, int coloff){
+	state.cy = cy < state.textrows ? cy : state.textrows - 1;
+	if(state.cy < 0) state.cy = 0;
+	if(col < 0) col = 0;
+	state.linenooff = calculateDigits(state.textrows) + 1;
+	state.cx = state.linenooff + (col < state.row[state.cy].size ? col : state.row[state.cy].size);
+	state.rowoff = rowoff > 0 ? rowoff : 0;
+	state.coloff = coloff > 0 ? coloff : 0;
+}
 
-	// store the position to in the buffer
-	appBuffAppend(&ab, buffer, strlen(buffer));
+// func to read the file passed to be read into its own buffer, returns the index of the buffer or -1 if the file could not be opened
+int editorOpen(char *filename){
+	// a file that is already open just gets its buffer shown
+	int existing = editorFindBuffer(filename);
+	if(existing != -1){
+		editorGotoBuffer(existing);
+		return existing;
+	}
 
-	// show the cursor
-	appBuffAppend(&ab, "\x1b[?25h", 6);
+	// a binary file would put its raw bytes on the terminal
+	if(!batchmode && editorIsBinary(filename)){
+		editorSetStatusMessage("%s is a binary file, view it with -x", filename);
+		errno = EINVAL;
+		return -1;
+	}
 
-	// now do one big write to the screen with the help of the buffer
-	write(STDOUT_FILENO, ab.b, ab.len);
+	// opening file to read contents
+	FILE *fp = fopen(filename, "r");
+	
+	// if the file could not be opened the error is left in errno for the caller
+	if(!fp){
+		int err = errno;
+		editorSetStatusMessage("Can't open %s: %s", filename, strerror(err));
+		errno = err;
+		return -1;
+	}
 
-	// free the buffer
-	appBuffFree(&ab);
+	editorTakeBuffer();
+
+	// automatically allocates and stores the filename
+	state.filename = strdup(filename);
+	editorReadRows(fp);
+	return bl.curr;
 }
 
-// func to set the status message
-void editorSetStatusMessage(const char *fmt, ...){
-	va_list ap;
-	va_start(ap, fmt);
-	vsnprintf(state.statusmsg, sizeof(state.statusmsg), fmt, ap);
-	va_end(ap);
-	state.statusmsg_time = time(NULL);
+// func to read the file of a buffer restored from a session, the cursor and view it was restored with are stored in the buffer with the cursor as a column of the text
+void editorLoadBuffer(){
+	bl.buffers[bl.curr].unloaded = 0;
+	int cy = state.cy, col = state.cx, rowoff = state.rowoff, coloff = state.coloff;
+
+	// a file that went away meanwhile leaves an empty buffer that can still be saved
+	FILE* fp = fopen(state.filename, "r");
+	if(fp) editorReadRows(fp);
+	else {
+		editorSetStatusMessage("Can't open %s: %s", state.filename, strerror(errno));
+		editorInsertRow(0, "", 0);
+		editorMarkSaved();
+		editorAddState();
+	}
+	editorRestoreView(cy, col, rowoff, coloff);
 }
 
-/***INPUT***/
+// func to mark the buffer being edited as saved once len bytes of it were written to the disk
+void editorSaved(int len){
+	// on saving we reset modified since the file on the disk and in file editor are the same
+	editorMarkSaved();
 
-// func to get the filename to save if he opens a blank editor
-char* editorPrompt(char* prompt, void (*callback)(char*, int)){
-	// initial buffeer size for the user input
-	size_t bufsize = 128;
+	// set status meeesage
+	editorSetStatusMessage("%d bytes written to disk", len);
+	
+	// update the states array to hold only thwe current state since the file was saved
+	editorResizeUR(1);
+	ur.size = 0;
+	ur.currStateIndex = 0;
 
-	// allocate a buffer to store user input
-	char* buf = malloc(bufsize);
-	size_t buflen = 0;
-	buf[0] = '\0';
+	// add it to the undoRedo state
+	editorAddState();
 
-	// loop till the user presses enter
-	while(1){
-		// renders the input typed by the user
-		editorSetStatusMessage(prompt, buf);
+	// a save is also a good point to bring the session up to date
+	if(!batchmode && !servermode) editorSaveSession();
+}
 
-		// called to repaint each render
-		editorRefreshScreen();
+// func to save the string to the file, returns -1 if nothing was written
+int editorSave(){
+	// todo for new file
+	if(state.filename == NULL){
+		// there is nobody to ask for a name in batch mode
+		if(batchmode){
+			editorSetStatusMessage("No file name");
+			return -1;
+		}
 
-		// reads each key pressed by the user
-		int c = editorReadKey();
-		
-		// if the user presses backspace we delete the previous char
-		if(c == DEL_KEY || c == CTRL_KEY('h') || c == BACKSPACE){
-			if(buflen != 0) buf[--buflen] = '\0';
+		state.filename = editorPrompt("Save as: %s (ESC to cancel)", NULL, NULL, NULL);
+
+		// if the user pressed escape
+		if(state.filename == NULL){
+			editorSetStatusMessage("Save aborted");
+			return -1;
+		}
+	}
+
+	// optional whitespace clean up before the text is written
+	if(opts.trimonsave) editorTransformLines(0, state.textrows, TRANSFORM_TRIM);
+	if(opts.expandonsave) editorTransformLines(0, state.textrows, TRANSFORM_EXPAND);
+	else if(opts.unexpandonsave) editorTransformLines(0, state.textrows, TRANSFORM_UNEXPAND);
+
+	// compressed files are written through their compressor
+	if(state.compress != COMPRESS_NONE){
+		int len = editorWriteCompressed();
+		if(len == -1){
+			editorSetStatusMessage("Can't save! %s failed: %s", codecs[state.compress].name, strerror(errno));
+			return -1;
+		}
+		editorSaved(len);
+		return 0;
+	}
+
+	// stores the length of the string created
+	int len;
+
+	//stores the string returned from the function that is thee entire updated text
+	char* buffer = editorRowsToString(&len);
+
+	// open the file to save the changes with the appropriate permissions
+	int fd = open(state.filename, O_RDWR | O_CREAT, 0644);
+	
+	if(fd != -1){
+		// sets the file size to the specified length
+		if(ftruncate(fd, len) != -1){
+			// write the new text to the file
+			if(write(fd, buffer, len) == len){
+				// close the file
+				close(fd);
+
+				// free the memory allocated for the buffer since the wrtitng is done
+				free(buffer);
+
+				editorSaved(len);
+				return 0;
+			}
+		}
+
+		close(fd);
+	}
+
+	free(buffer);
+	
+	// set status message
+	editorSetStatusMessage("Can't save! I/O error: %s", strerror(errno));
+	return -1;
+}
+
+/***SESSION***/
+
+// func to get the path of the session file, $YETI_SESSION if it is set else ~/.yeti_session
+char* editorSessionPath(){
+	const char* env = getenv("YETI_SESSION");
+	if(env && *env) return strdup(env);
+
+	const char* home = getenv("HOME");
+	if(home == NULL) home = ".";
+	char* path = malloc(strlen(home) + 16);
+	sprintf(path, "%s/.yeti_session", home);
+	return path;
+}
+
+// func to write a length prefixed string to the session file
+void editorSessionPutString(FILE* fp, const char* str){
+	int len = strlen(str);
+	fwrite(&len, sizeof(len), 1, fp);
+	fwrite(str, 1, len, fp);
+}
+
+// func to read a length prefixed string from the session file, returns NULL if the file ends or is damaged
+char* editorSessionGetString(FILE* fp){
+	int len;
+	if(fread(&len, sizeof(len), 1, fp) != 1 || len < 0 || len > 65536) return NULL;
+
+	char* str = malloc(len + 1);
+	if(fread(str, 1, len, fp) != (size_t)len){
+		free(str);
+		return NULL;
+	}
+	str[len] = '\0';
+	return str;
+}
+
+// func to write the open files with their cursor and view and the search history to the session file, it is written next to it and renamed over it so a crash never leaves half a session, returns -1 on failure
+int editorSaveSession(){
+	char* path = editorSessionPath();
+	char* tmp = malloc(strlen(path) + 5);
+	sprintf(tmp, "%s.tmp", path);
+
+	FILE* fp = fopen(tmp, "wb");
+	if(fp == NULL){
+		free(tmp);
+		free(path);
+		return -1;
+	}
+
+	// only buffers with a file can be opened again
+	int named = 0, curr = -1;
+	for(int j = 0; j < bl.size; j++){
+		if(editorBufferState(j)->filename == NULL) continue;
+		if(j == bl.curr) curr = named;
+		named++;
+	}
+
+	int version = YETI_SESSION_VERSION;
+	fwrite(YETI_SESSION_MAGIC, 1, 4, fp);
+	fwrite(&version, sizeof(version), 1, fp);
+	fwrite(&named, sizeof(named), 1, fp);
+	fwrite(&curr, sizeof(curr), 1, fp);
+
+	for(int j = 0; j < bl.size; j++){
+		struct editorConfig* s = editorBufferState(j);
+		if(s->filename == NULL) continue;
+
+		// the path is stored absolute so the session can be restored from anywhere
+		char* abs = realpath(s->filename, NULL);
+		editorSessionPutString(fp, abs ? abs : s->filename);
+		free(abs);
+
+		// the cursor column is stored without the line no. column since its width depends on the no. of lines
+		int view[4] = {s->cy, s->cx > s->linenooff ? s->cx - s->linenooff : 0, s->rowoff, s->coloff};
+		fwrite(view, sizeof(int), 4, fp);
+	}
+
+	fwrite(&searchhist.size, sizeof(searchhist.size), 1, fp);
+	for(int j = 0; j < searchhist.size; j++) editorSessionPutString(fp, searchhist.items[j]);
+
+	// the commands come last so sessions saved without them still load
+	fwrite(&cmdhist.size, sizeof(cmdhist.size), 1, fp);
+	for(int j = 0; j < cmdhist.size; j++) editorSessionPutString(fp, cmdhist.items[j]);
+
+	// the session only replaces the old one once it is safely on the disk
+	int ok = !ferror(fp) && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+	if(fclose(fp) != 0) ok = 0;
+	if(ok) ok = rename(tmp, path) == 0;
+	if(!ok) unlink(tmp);
+
+	free(tmp);
+	free(path);
+	return ok ? 0 : -1;
+}
+
+// func to reopen the files of the last session with their cursor and view and restore the search history, files that are gone are skipped, returns -1 if there is no session
+int editorLoadSession(){
+	char* path = editorSessionPath();
+	FILE* fp = fopen(path, "rb");
+	free(path);
+	if(fp == NULL){
+		editorSetStatusMessage("No session to restore");
+		return -1;
+	}
+
+	char magic[4];
+	int version, named, curr;
+	if(fread(magic, 1, 4, fp) != 4 || memcmp(magic, YETI_SESSION_MAGIC, 4) != 0 || fread(&version, sizeof(version), 1, fp) != 1 || version != YETI_SESSION_VERSION || fread(&named, sizeof(named), 1, fp) != 1 || fread(&curr, sizeof(curr), 1, fp) != 1){
+		fclose(fp);
+		editorSetStatusMessage("Not a session file");
+		return -1;
+	}
+
+	int target = -1, restored = 0;
+	for(int j = 0; j < named; j++){
+		char* filename = editorSessionGetString(fp);
+		int view[4];
+		if(filename == NULL || fread(view, sizeof(int), 4, fp) != 4){
+			free(filename);
+			break;
+		}
+
+		// only the file that was being edited is read now, the others are read once they are shown
+		if(j == curr){
+			target = editorOpen(filename);
+			if(target != -1){
+				editorRestoreView(view[0], view[1], view[2], view[3]);
+				restored++;
+			}
+		} else if(editorFindBuffer(filename) == -1 && access(filename, R_OK) == 0){
+			editorTakeBuffer();
+			state.filename = strdup(filename);
+			state.cy = view[0];
+			state.cx = view[1];
+			state.rowoff = view[2];
+			state.coloff = view[3];
+			bl.buffers[bl.curr].unloaded = 1;
+			restored++;
+		}
+		free(filename);
+	}
+
+	int hists;
+	struct editorHistory* restore[] = {&searchhist, &cmdhist};
+	for(int k = 0; k < 2 && fread(&hists, sizeof(hists), 1, fp) == 1; k++){
+		for(int j = 0; j < hists; j++){
+			char* item = editorSessionGetString(fp);
+			if(item == NULL) break;
+			editorHistoryAdd(restore[k], item);
+			free(item);
+		}
+	}
+	fclose(fp);
+
+	// the buffer shown must be read even if the one that was being edited is gone
+	if(target != -1) editorSwitchBuffer(target);
+	if(bl.buffers[bl.curr].unloaded) editorLoadBuffer();
+	editorSetStatusMessage("Session restored: %d of %d files", restored, named);
+	return 0;
+}
+
+/***QUIT***/
+
+// funcc to tell the terminal to clear the screen and postion the cursor to the top-left
+void editorQuit(){	
+	// quitting a client of the server only disconnects it
+	if(servermode){
+		cl.clients[cl.curr].gone = 1;
+		return;
+	}
+
+	if(!batchmode){
+		if(!pagermode) editorSaveSession();
+		write(STDOUT_FILENO, "\x1b[2J", 4);
+		write(STDOUT_FILENO, "\x1b[H", 3);
+	}
+	exit(0);
+}
+
+/***UNDO***/
+
+// func to handle the undo feature
+void editorUndoState(){
+	// nothing was recorded yet, which is always the case in batch mode
+	if(ur.states == NULL || ur.size == 0){
+		editorSetStatusMessage("Nothing to undo");
+		return;
+	}
+
+	// if the current state is the same as the fiel saaved to disk , we donot undo
+	if(ur.currStateIndex > 0) ur.currStateIndex -= 1;
+	
+	// showws a message if the current state is the same as the file saved to disk
+	if(ur.currStateIndex < 0 || (ur.currStateIndex == 0 && state.modified == 0)){
+		ur.currStateIndex = 0;
+		editorSetStatusMessage("Current file matches with the file on the disk");
+		return;
+	}  
+	
+	// reduce the states stored on every undo
+	if(ur.size != 1) {
+		ur.size -= 1;
+		editorResizeUR(ur.size);
+	}
+	
+	// the screen belongs to the window and the editor and not to the undo state, so it is kept like when switching buffers
+	int screenrows = state.screenrows;
+	int screencols = state.screencols;
+	struct termios orig = state.orig;
+	char statusmsg[sizeof(state.statusmsg)];
+	strcpy(statusmsg, state.statusmsg);
+
+	// update the state according to the current undo index, its rows get their own text back to be edited
+	state = *ur.clone(&ur.states[ur.currStateIndex]);
+	state.screenrows = screenrows;
+	state.screencols = screencols;
+	state.orig = orig;
+	strcpy(state.statusmsg, statusmsg);
+	for(int j = 0; j < state.textrows; j++){
+		erow* row = &state.row[j];
+		row->text = malloc(row->size + 1);
+		memcpy(row->text, row->line->text, row->size + 1);
+		editorRenderRow(row);
+	}
+	editorCheckModified();
+	editorSetStatusMessage("Undo successfull!");
+	editorRefreshScreen();
+}
+
+/***FIND***/
+
+void editorFindCallback(char* query, int key){
+	// static variables that maintain the last search positions
+	static int last_match = -1;
+	static int direction = 1;
+	
+	// move the cursor to the next or previous match
+	if(key == '\r' || key == '\x1b'){
+		last_match = -1;
+		direction = 1;
+		return;
+	} else if(key == ARROW_RIGHT || key == ARROW_DOWN) direction = 1;
+
+	else if(key == ARROW_LEFT || key == ARROW_UP) direction = -1;
+	
+	// reset the variables for the next search
+	else{
+		last_match = -1;
+		direction = 1;
+	}
+
+	if(last_match == -1) direction = 1;
+	int current  = last_match;
+
+	// loop to search the query
+	for(int i = 0; i < state.textrows; i++){
+		current += direction;
+		if(current == -1) current = state.textrows - 1;
+		else if(current == state.textrows) current = 0;
+		erow* row = &state.row[current];
+		
+		// checks if the query is a sssubstring of the current row
+		char* match = strstr(row->render, query);
+
+		// if it is a substring
+		if(match) {
+			last_match = current;
+
+			// update the state
+			state.cy = current;
+			state.cx = editorRowRxToCx(row, match - row->render) + state.linenooff;
+			state.rowoff = state.textrows;
+			break;
+		}
+	}
+
+}
+
+// func for searching
+void editorFind(){
+	
+	// save the initial state before searching
+	int saved_cx = state.cx;
+	int saved_cy = state.cy;
+	int saved_coloff = state.coloff;
+	int saved_rowoff = state.rowoff;
+
+	// get the query typed by the user
+	char* query = editorPrompt("Search: %s (ESC to cancel)", &searchhist, editorFindCallback, NULL);
+	
+	// free space once the user exits the search, the position it started from can be jumped back to
+	if(query){
+		free(query);
+		editorJumpPush(saved_cy, saved_cx);
+	}
+	
+	// when the user exits search mode, we return the cursor to the original position
+	else {
+		state.cx = saved_cx;
+		state.cy = saved_cy;
+		state.coloff = saved_coloff;
+		state.rowoff = saved_rowoff;
+	}
+
+}
+
+/***LINE COMMANDS***/
+
+// func to compare two rows byte by byte, the shorter row comes first when one is a prefix of the other
+int editorRowCmp(const erow* a, const erow* b){
+	int n = a->size < b->size ? a->size : b->size;
+	int r = memcmp(a->text, b->text, n);
+	if(r) return r;
+	return a->size - b->size;
+}
+
+// func to merge the sorted runs src[lo, mid) and src[mid, hi) into dst, only the erow structs are moved and never the text
+void editorMergeRows(const erow* src, erow* dst, int lo, int mid, int hi){
+	int i = lo, j = mid, k = lo;
+	while(i < mid && j < hi){
+		// taking from the left run on a tie keeps the sort stable
+		if(editorRowCmp(&src[j], &src[i]) < 0) dst[k++] = src[j++];
+		else dst[k++] = src[i++];
+	}
+	while(i < mid) dst[k++] = src[i++];
+	while(j < hi) dst[k++] = src[j++];
+}
+
+// func to merge sort rows[lo, hi) using tmp as scratch space, the result ends up in rows
+void editorSortRows(erow* rows, erow* tmp, int lo, int hi){
+	// short runs are insertion sorted
+	if(hi - lo <= 16){
+		for(int i = lo + 1; i < hi; i++){
+			erow r = rows[i];
+			int j = i - 1;
+			while(j >= lo && editorRowCmp(&rows[j], &r) > 0){
+				rows[j + 1] = rows[j];
+				j--;
+			}
+			rows[j + 1] = r;
+		}
+		return;
+	}
+
+	int mid = lo + (hi - lo) / 2;
+	editorSortRows(rows, tmp, lo, mid);
+	editorSortRows(rows, tmp, mid, hi);
+
+	// nothing to merge if both halves are already in order
+	if(editorRowCmp(&rows[mid - 1], &rows[mid]) <= 0) return;
+
+	editorMergeRows(rows, tmp, lo, mid, hi);
+	memcpy(&rows[lo], &tmp[lo], sizeof(erow) * (hi - lo));
+}
+
+// struct shared by the threads of a parallel sort
+struct editorSortJob{
+	erow* src; // rows holding the sorted runs
+	erow* dst; // scratch space the runs get merged into
+	int* bounds; // boundaries of the sorted runs
+	int runs; // no. of sorted runs
+};
+
+// func run by each thread to sort its share of runs
+void editorSortRunWorker(int lo, int hi, void* arg){
+	struct editorSortJob* job = arg;
+	for(int i = lo; i < hi; i++) editorSortRows(job->src, job->dst, job->bounds[i], job->bounds[i + 1]);
+}
+
+// func run by each thread to merge its share of run pairs
+void editorMergeRunWorker(int lo, int hi, void* arg){
+	struct editorSortJob* job = arg;
+	for(int i = lo; i < hi; i++){
+		int a = job->bounds[2 * i];
+
+		// an odd run out is just carried over to the next pass
+		if(2 * i + 1 >= job->runs){
+			memcpy(&job->dst[a], &job->src[a], sizeof(erow) * (job->bounds[job->runs] - a));
+			continue;
+		}
+
+		editorMergeRows(job->src, job->dst, a, job->bounds[2 * i + 1], job->bounds[2 * i + 2]);
+	}
+}
+
+// func to stable sort n rows, large ranges are cut into one run per core which are sorted and then merged pairwise in parallel
+void editorParallelSortRows(erow* rows, int n){
+	if(n < 2) return;
+
+	erow* tmp = malloc(sizeof(erow) * n);
+	if(tmp == NULL) die("malloc");
+
+	// one run per core for large ranges, else a single run sorted on this thread
+	long runs = (n >= YETI_PARALLEL_MIN_ROWS) ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+	if(runs > YETI_MAX_THREADS) runs = YETI_MAX_THREADS;
+	if(runs < 1) runs = 1;
+
+	int bounds[YETI_MAX_THREADS + 1];
+	for(int i = 0; i <= runs; i++) bounds[i] = (int)((long long)n * i / runs);
+
+	struct editorSortJob job = {rows, tmp, bounds, (int)runs};
+	editorParallelFor(job.runs, 1, editorSortRunWorker, &job);
+
+	// merge the runs pairwise till only one is left, swapping the source and scratch space on every pass
+	while(job.runs > 1){
+		int pairs = (job.runs + 1) / 2;
+		editorParallelFor(pairs, 1, editorMergeRunWorker, &job);
+
+		for(int i = 0; i < pairs; i++) job.bounds[i] = job.bounds[2 * i];
+		job.bounds[pairs] = n;
+		job.runs = pairs;
+
+		erow* t = job.src;
+		job.src = job.dst;
+		job.dst = t;
+	}
+
+	// copy back if the last pass left the result in the scratch space
+	if(job.src != rows) memcpy(rows, job.src, sizeof(erow) * n);
+	free(tmp);
+}
+
+// func to sort a copy of the rows of the sort under way till due, short runs are insertion sorted first and then merged pairwise a pass at a time, returns 1 once the copy is sorted
+int editorSortStep(long long due){
+	int n = work.end - work.start;
+	int steps = 0;
+
+	while(work.width == 0){
+		if(work.lo >= n){
+			work.width = 16;
+			work.lo = work.i = work.k = 0;
+			work.j = n < 16 ? n : 16;
+			work.pass++;
+			break;
+		}
+		int hi = work.lo + 16 < n ? work.lo + 16 : n;
+		editorSortRows(work.src, work.dst, work.lo, hi);
+		work.lo = hi;
+		if((++steps & 63) == 0 && editorNow() >= due) goto out;
+	}
+
+	while(work.width < n){
+		while(work.lo < n){
+			int mid = work.lo + work.width < n ? work.lo + work.width : n;
+			int hi = work.lo + 2 * work.width < n ? work.lo + 2 * work.width : n;
+
+			// taking from the left run on a tie keeps the sort stable
+			while(work.k < hi){
+				if(work.i < mid && (work.j >= hi || editorRowCmp(&work.src[work.j], &work.src[work.i]) >= 0)) work.dst[work.k++] = work.src[work.i++];
+				else work.dst[work.k++] = work.src[work.j++];
+				if((++steps & 1023) == 0 && editorNow() >= due) goto out;
+			}
+
+			work.lo = work.i = work.k = hi;
+			work.j = hi + work.width < n ? hi + work.width : n;
+		}
+
+		// the merged runs are the source of the next pass
+		erow* t = work.src;
+		work.src = work.dst;
+		work.dst = t;
+		work.width *= 2;
+		work.lo = work.i = work.k = 0;
+		work.j = work.width < n ? work.width : n;
+		work.pass++;
+	}
+
+out:
+	work.percent = (int)(((long long)work.pass * n + work.lo) * 100 / ((long long)work.passes * n));
+	return work.width >= n;
+}
+
+// func to wrap up the sort under way, the buffer only gets the sorted rows if it was not cancelled
+void editorSortFinish(int cancelled){
+	int n = work.end - work.start;
+	if(!cancelled) memcpy(&state.row[work.start], work.src, sizeof(erow) * n);
+	free(work.src);
+	free(work.dst);
+	work.src = work.dst = NULL;
+
+	if(cancelled){
+		editorSetStatusMessage("Sort cancelled, nothing changed");
+		return;
+	}
+
+	// the whole sort is recorded as a single undo state, the rows kept their hashes and only their order changed
+	editorRehash();
+	state.edits++;
+	editorAddState();
+	editorSetStatusMessage("%d lines sorted", n);
+}
+
+// func to sort the rows [start, end), in batch and server mode it is done at once across the cores and else a slice at a time between keys
+void editorSortLines(int start, int end){
+	int n = end - start;
+	if(n < 2) return;
+
+	if(batchmode || servermode){
+		editorParallelSortRows(&state.row[start], n);
+		editorRehash();
+		state.edits++;
+		editorAddState();
+		editorSetStatusMessage("%d lines sorted", n);
+		return;
+	}
+
+	// the rows are sorted in a copy so the buffer is never left half sorted
+	work.src = malloc(sizeof(erow) * n);
+	work.dst = malloc(sizeof(erow) * n);
+	if(work.src == NULL || work.dst == NULL) die("malloc");
+	memcpy(work.src, &state.row[start], sizeof(erow) * n);
+
+	work.start = start;
+	work.end = end;
+	work.width = 0;
+	work.lo = 0;
+	work.pass = 0;
+	work.passes = 1;
+	for(int w = 16; w < n; w *= 2) work.passes++;
+	work.step = editorSortStep;
+	work.finish = editorSortFinish;
+	editorWorkStart("sort");
+}
+
+// func to remove adjacent duplicate rows from [start, end)
+void editorUniqLines(int start, int end){
+	if(end - start < 2) return;
+
+	// compact the unique rows towards the start of the range and free the duplicates
+	int w = start + 1;
+	for(int r = start + 1; r < end; r++){
+		if(editorRowCmp(&state.row[r], &state.row[w - 1]) == 0) editorFreeRow(&state.row[r]);
+		else state.row[w++] = state.row[r];
+	}
+
+	// close the gap left by the removed rows with a single move
+	int removed = end - w;
+	memmove(&state.row[w], &state.row[end], sizeof(erow) * (state.textrows - end));
+	state.textrows -= removed;
+	editorClampCursor();
+
+	editorRehash();
+	state.edits++;
+	editorAddState();
+	editorSetStatusMessage("%d duplicate lines removed", removed);
+}
+
+// func to reverse the order of the rows [start, end)
+void editorReverseLines(int start, int end){
+	if(end - start < 2) return;
+
+	for(int i = start, j = end - 1; i < j; i++, j--){
+		erow t = state.row[i];
+		state.row[i] = state.row[j];
+		state.row[j] = t;
+	}
+
+	editorRehash();
+	state.edits++;
+	editorAddState();
+	editorSetStatusMessage("%d lines reversed", end - start);
+}
+
+// func to indent row j by one tab unless it is empty, only the text and render prefix of the row is touched, returns 1 if it changed
+int editorIndentRow(int j){
+	erow* row = &state.row[j];
+	if(row->size == 0) return 0;
+
+	row->text = realloc(row->text, row->size + 2);
+	memmove(&row->text[1], row->text, row->size + 1);
+	row->text[0] = '\t';
+	row->size++;
+
+	// a tab in the first column always takes a full tab stop so the rest of the render just moves right
+	editorRowShiftRender(row, YETI_TAB_STOP);
+
+	if(j == state.cy) state.cx++;
+	return 1;
+}
+
+// func to remove one level of indentation (a tab or up to a tab stop of spaces) from row j, returns 1 if it changed
+int editorDedentRow(int j){
+	erow* row = &state.row[j];
+
+	// the no. of whitespace chars removed from the front and the columns they took up
+	int n = 0, width = 0;
+	if(row->size && row->text[0] == '\t'){
+		n = 1;
+		width = YETI_TAB_STOP;
+	} else {
+		while(n < row->size && n < YETI_TAB_STOP && row->text[n] == ' ') n++;
+		width = n;
+	}
+	if(n == 0) return 0;
+
+	memmove(row->text, &row->text[n], row->size - n + 1);
+	row->size -= n;
+
+	// the render only moves left uniformly if every later tab stop moved by a whole tab or there are no tabs left, else it is rebuilt
+	if(width == YETI_TAB_STOP || memchr(row->text, '\t', row->size) == NULL) editorRowShiftRender(row, -width);
+	else editorUpdateRow(row);
+
+	if(j == state.cy){
+		state.cx -= n;
+		if(state.cx < state.linenooff) state.cx = state.linenooff;
+	}
+	return 1;
+}
+
+// func to indent the non empty rows [start, end) by one tab, a large range is done a slice at a time between keys
+void editorIndentLines(int start, int end){
+	work.start = work.next = start;
+	work.end = end;
+	work.step = editorWorkRows;
+	work.finish = editorWorkRowsFinish;
+	work.row = editorIndentRow;
+	work.what = "lines indented";
+	editorWorkStart("indent");
+}
+
+// func to dedent the rows [start, end), a large range is done a slice at a time between keys
+void editorDedentLines(int start, int end){
+	work.start = work.next = start;
+	work.end = end;
+	work.step = editorWorkRows;
+	work.finish = editorWorkRowsFinish;
+	work.row = editorDedentRow;
+	work.what = "lines dedented";
+	editorWorkStart("dedent");
+}
+
+/***WHITESPACE***/
+
+// func to remove the trailing whitespace of a row, returns 1 if the row changed
+int editorRowTrim(erow* row){
+	int size = editorLastNonBlank(row->text, row->size, 1) + 1;
+	if(size == row->size) return 0;
+
+	row->size = size;
+	row->text[size] = '\0';
+
+	// trailing tabs and spaces only ever render as trailing spaces and the kept text ends in a non blank char, so the render is trimmed the same way
+	if(row->render){
+		row->rsize = editorLastNonBlank(row->render, row->rsize, 0) + 1;
+		row->render[row->rsize] = '\0';
+	}
+	return 1;
+}
+
+// func to expand the tabs of a row into spaces, returns 1 if the row changed
+int editorRowExpand(erow* row){
+	int tabs = editorCountByte(row->text, row->size, '\t');
+	if(tabs == 0) return 0;
+
+	char* text = malloc(row->size + tabs * (YETI_TAB_STOP - 1) + 1);
+	row->size = editorExpandTabs(row->text, row->size, text);
+	text[row->size] = '\0';
+	free(row->text);
+	row->text = text;
+
+	// the render already was the text with its tabs expanded
+	return 1;
+}
+
+// func to rewrite the leading whitespace of a row as tabs followed by the spaces left over, returns 1 if the row changed
+int editorRowUnexpand(erow* row){
+	// find the width of the leading whitespace
+	int n = 0, width = 0;
+	for(; n < row->size; n++){
+		if(row->text[n] == ' ') width++;
+		else if(row->text[n] == '\t') width += YETI_TAB_STOP - (width % YETI_TAB_STOP);
+		else break;
+	}
+
+	int tabs = width / YETI_TAB_STOP;
+	int spaces = width % YETI_TAB_STOP;
+	int len = tabs + spaces;
+
+	// nothing to do if the prefix is already in that form
+	int same = (len == n);
+	for(int j = 0; same && j < len; j++) same = (row->text[j] == (j < tabs ? '\t' : ' '));
+	if(same) return 0;
+
+	// the new prefix is never longer than the old one so it is rewritten in place
+	memset(row->text, '\t', tabs);
+	memset(&row->text[tabs], ' ', spaces);
+	memmove(&row->text[len], &row->text[n], row->size - n + 1);
+	row->size -= n - len;
+
+	// the prefix takes up the same no. of columns as before so the render does not change
+	return 1;
+}
+
+// struct shared by the threads of a whitespace transform
+struct editorTransformJob{
+	erow* rows; // first row of the range
+	enum editorTransform kind; // transform to run
+	int changed; // no. of rows that were changed
+};
+
+// func run by each thread on its share of rows
+void editorTransformWorker(int lo, int hi, void* arg){
+	struct editorTransformJob* job = arg;
+	int changed = 0;
+
+	for(int j = lo; j < hi; j++){
+		erow* row = &job->rows[j];
+		int c = 0;
+		switch(job->kind){
+			case TRANSFORM_TRIM: c = editorRowTrim(row); break;
+			case TRANSFORM_EXPAND: c = editorRowExpand(row); break;
+			case TRANSFORM_UNEXPAND: c = editorRowUnexpand(row); break;
+		}
+
+		// only the hash and line of the row are updated here, the hash of the buffer is rebuilt once every thread is done
+		if(c){
+			row->hash = editorHashBytes(row->text, row->size);
+			editorLineRelease(row->line);
+			row->line = NULL;
+		}
+		changed += c;
+	}
+
+	__atomic_fetch_add(&job->changed, changed, __ATOMIC_RELAXED);
+}
+
+// func to run a whitespace transform over the rows [start, end), large ranges are split across threads, returns the no. of rows changed
+int editorTransformLines(int start, int end, enum editorTransform kind){
+	if(end <= start) return 0;
+
+	struct editorTransformJob job = {&state.row[start], kind, 0};
+	editorParallelFor(end - start, YETI_PARALLEL_MIN_ROWS, editorTransformWorker, &job);
+
+	// the cursor may now be past the end of its row
+	editorClampCursor();
+
+	// the whole pass is recorded as a single undo state
+	if(job.changed){
+		editorRehash();
+		state.edits++;
+		editorAddState();
+	}
+
+	return job.changed;
+}
+
+// func to run a whitespace transform from the command prompt
+void editorTransformCommand(int start, int end, enum editorTransform kind){
+	int changed = editorTransformLines(start, end, kind);
+	editorSetStatusMessage("%d lines changed", changed);
+}
+
+/***FILTER***/
+
+// environment handed to the spawned commands
+extern char** environ;
+
+// func to run argv with its stdin and stdout connected to pipes, stderr is discarded so it does not garble the screen
+pid_t editorSpawnArgv(char* const argv[], int* tochild, int* fromchild){
+	int in[2], out[2];
+
+	// the pipes are close on exec so the child does not keep its own stdin open
+	if(pipe2(in, O_CLOEXEC) == -1) return -1;
+	if(pipe2(out, O_CLOEXEC) == -1){
+		close(in[0]);
+		close(in[1]);
+		return -1;
+	}
+
+	posix_spawn_file_actions_t fa;
+	posix_spawn_file_actions_init(&fa);
+	posix_spawn_file_actions_adddup2(&fa, in[0], STDIN_FILENO);
+	posix_spawn_file_actions_adddup2(&fa, out[1], STDOUT_FILENO);
+	posix_spawn_file_actions_addopen(&fa, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+	// the editor ignores SIGPIPE while commands run, the command itself should still die of it like it does in a shell
+	posix_spawnattr_t attr;
+	posix_spawnattr_init(&attr);
+	sigset_t def;
+	sigemptyset(&def);
+	sigaddset(&def, SIGPIPE);
+	posix_spawnattr_setsigdefault(&attr, &def);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+
+	pid_t pid;
+	int err = posix_spawnp(&pid, argv[0], &fa, &attr, argv, environ);
+	posix_spawn_file_actions_destroy(&fa);
+	posix_spawnattr_destroy(&attr);
+
+	// the child has its own copies of these ends
+	close(in[0]);
+	close(out[1]);
+
+	if(err){
+		close(in[1]);
+		close(out[0]);
+		errno = err;
+		return -1;
+	}
+
+	*tochild = in[1];
+	*fromchild = out[0];
+	return pid;
+}
+
+// func to write n rows to fd with one writev() per batch of rows, returns -1 if the write fails (e.g. the reader went away)
+int editorWriteRows(int fd, erow* rows, int n){
+	struct iovec iov[YETI_IOV_BATCH];
+	int next = 0;
+
+	while(next < n){
+		// each row is written as its text followed by a newline
+		int cnt = 0;
+		while(next < n && cnt + 2 <= YETI_IOV_BATCH){
+			iov[cnt].iov_base = rows[next].text;
+			iov[cnt++].iov_len = rows[next].size;
+			iov[cnt].iov_base = "\n";
+			iov[cnt++].iov_len = 1;
+			next++;
+		}
+
+		// write the batch, picking up where a partial write left off
+		struct iovec* v = iov;
+		while(cnt > 0){
+			ssize_t nw = writev(fd, v, cnt);
+			if(nw == -1){
+				if(errno == EINTR) continue;
+				return -1;
+			}
+			while(cnt > 0 && (size_t)nw >= v->iov_len){
+				nw -= v->iov_len;
+				v++;
+				cnt--;
+			}
+			if(cnt > 0){
+				v->iov_base = (char*)v->iov_base + nw;
+				v->iov_len -= nw;
+			}
+		}
+	}
+
+	return 0;
+}
+
+// func to write the lines of a version to fd with one writev() from the given position on, the position is moved past what was written, returns the no. of bytes written or -1
+ssize_t editorVersionWrite(int fd, struct editorVersion* v, int* line, int* off){
+	struct iovec iov[YETI_IOV_BATCH];
+	int cnt = 0;
+	for(int j = *line; j < v->n && cnt + 2 <= YETI_IOV_BATCH; j++){
+		int skip = j == *line ? *off : 0;
+		if(skip < v->lines[j]->len){
+			iov[cnt].iov_base = v->lines[j]->text + skip;
+			iov[cnt++].iov_len = v->lines[j]->len - skip;
+		}
+		iov[cnt].iov_base = "\n";
+		iov[cnt++].iov_len = 1;
+	}
+	if(cnt == 0) return 0;
+
+	ssize_t nw = writev(fd, iov, cnt);
+	if(nw == -1) return -1;
+
+	// each line takes its length plus the newline
+	ssize_t left = nw;
+	while(left > 0){
+		int rest = v->lines[*line]->len + 1 - *off;
+		if(left < rest){
+			*off += left;
+			break;
+		}
+		left -= rest;
+		(*line)++;
+		*off = 0;
+	}
+	return nw;
+}
+
+// struct to collect rows that are built outside the state
+struct editorRowList{
+	erow* rows; // rows built so far
+	int n; // no. of rows
+	int cap; // no. of rows there is space for
+};
+
+// func to append a line to a row list
+void editorRowListAppend(struct editorRowList* list, const char* s, size_t len){
+	if(list->n == list->cap){
+		list->cap = list->cap ? list->cap * 2 : 64;
+		list->rows = realloc(list->rows, sizeof(erow) * list->cap);
+		if(list->rows == NULL) die("realloc");
+	}
+
+	erow* row = &list->rows[list->n++];
+	row->size = len;
+	row->text = malloc(len + 1);
+	memcpy(row->text, s, len);
+	row->text[len] = '\0';
+	row->render = NULL;
+	row->rsize = 0;
+	row->id = ++lastrowid;
+	row->line = NULL;
+	editorUpdateRow(row);
+}
+
+// func to free the rows of a row list
+void editorRowListFree(struct editorRowList* list){
+	for(int j = 0; j < list->n; j++) editorFreeRow(&list->rows[j]);
+	free(list->rows);
+	list->rows = NULL;
+	list->n = list->cap = 0;
+}
+
+// func to split a chunk read from a pipe into lines appended to a row list, the unfinished last line is held back in carry till the next chunk
+void editorRowListFeed(struct editorRowList* list, char** carry, size_t* carrylen, char* p, size_t n){
+	char* end = p + n;
+	char* nl;
+	while((nl = memchr(p, '\n', end - p)) != NULL){
+		size_t len = nl - p;
+		if(*carrylen){
+			// finish the line started in a previous chunk
+			*carry = realloc(*carry, *carrylen + len);
+			memcpy(*carry + *carrylen, p, len);
+			len += *carrylen;
+			if(len > 0 && (*carry)[len - 1] == '\r') len--;
+			editorRowListAppend(list, *carry, len);
+			*carrylen = 0;
+		} else {
+			if(len > 0 && p[len - 1] == '\r') len--;
+			editorRowListAppend(list, p, len);
+		}
+		p = nl + 1;
+	}
+
+	// hold back the unfinished line
+	if(p < end){
+		*carry = realloc(*carry, *carrylen + (end - p));
+		memcpy(*carry + *carrylen, p, end - p);
+		*carrylen += end - p;
+	}
+}
+
+// func to finish a row list at the end of the pipe, a last line without a trailing newline is added
+void editorRowListEnd(struct editorRowList* list, char** carry, size_t* carrylen){
+	if(*carrylen) editorRowListAppend(list, *carry, *carrylen);
+	free(*carry);
+	*carry = NULL;
+	*carrylen = 0;
+}
+
+// func to read lines from fd till eof straight into a row list, only the unfinished last line of each chunk is held back
+void editorReadRowsFromFd(int fd, struct editorRowList* list){
+	char chunk[YETI_PIPE_CHUNK];
+
+	// holds the start of a line that was cut at the end of a chunk
+	char* carry = NULL;
+	size_t carrylen = 0;
+
+	while(1){
+		ssize_t nread = read(fd, chunk, sizeof(chunk));
+		if(nread == -1 && errno == EINTR) continue;
+		if(nread <= 0) break;
+		editorRowListFeed(list, &carry, &carrylen, chunk, nread);
+	}
+	editorRowListEnd(list, &carry, &carrylen);
+}
+
+// func to run a codec command with its stdin and stdout on the given descriptors, stderr is discarded so it does not garble the screen
+pid_t editorSpawnCodec(char* const argv[], int infd, int outfd){
+	posix_spawn_file_actions_t fa;
+	posix_spawn_file_actions_init(&fa);
+	posix_spawn_file_actions_adddup2(&fa, infd, STDIN_FILENO);
+	posix_spawn_file_actions_adddup2(&fa, outfd, STDOUT_FILENO);
+	posix_spawn_file_actions_addopen(&fa, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+	pid_t pid;
+	int err = posix_spawnp(&pid, argv[0], &fa, NULL, argv, environ);
+	posix_spawn_file_actions_destroy(&fa);
+	if(err){
+		errno = err;
+		return -1;
+	}
+	return pid;
+}
+
+// func to read a compressed file into the buffer being edited, the decompressor runs alongside while its output is split into rows as it arrives, returns -1 if it could not all be read
+int editorReadCompressedRows(FILE* fp){
+	struct editorCodec* codec = &codecs[state.compress];
+	struct editorRowList list = {NULL, 0, 0};
+
+	int out[2];
+	pid_t pid = -1;
+	if(pipe2(out, O_CLOEXEC) == 0){
+		pid = editorSpawnCodec(codec->decompress, fileno(fp), out[1]);
+		close(out[1]);
+		if(pid != -1) editorReadRowsFromFd(out[0], &list);
+		close(out[0]);
+	}
+
+	int status = -1;
+	if(pid != -1) while(waitpid(pid, &status, 0) == -1 && errno == EINTR);
+
+	// the rows are only appended once they are all read since the state is empty at this point anyway
+	state.row = realloc(state.row, sizeof(erow) * (state.textrows + list.n));
+	memcpy(&state.row[state.textrows], list.rows, sizeof(erow) * list.n);
+	state.textrows += list.n;
+	state.hash += editorHashSpan(state.textrows - list.n, state.textrows);
+	free(list.rows);
+
+	// a damaged file or a missing tool leaves what could be read, the caller marks it as changed so it is not thrown away unnoticed
+	if(pid == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+		editorSetStatusMessage("%s could not decompress %s, the text may be incomplete", codec->decompress[0], state.filename);
+		return -1;
+	}
+	return 0;
+}
+
+// func to write the buffer being edited through the compressor of its format, the rows are streamed into it and its output goes to a file next to the original that is renamed over it once it is complete, returns the no. of bytes written or -1 on failure
+int editorWriteCompressed(){
+	char* tmp = malloc(strlen(state.filename) + 5);
+	sprintf(tmp, "%s.tmp", state.filename);
+
+	// the new file keeps the permissions of the one it replaces
+	struct stat st;
+	mode_t mode = stat(state.filename, &st) == 0 ? st.st_mode & 07777 : 0644;
+	int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+	if(fd == -1){
+		free(tmp);
+		return -1;
+	}
+	fchmod(fd, mode);
+
+	int in[2];
+	if(pipe2(in, O_CLOEXEC) == -1){
+		int err = errno;
+		close(fd);
+		unlink(tmp);
+		free(tmp);
+		errno = err;
+		return -1;
+	}
+
+	// a compressor that dies early must not kill the editor with SIGPIPE
+	struct sigaction ign, old;
+	memset(&ign, 0, sizeof(ign));
+	ign.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &ign, &old);
+
+	pid_t pid = editorSpawnCodec(codecs[state.compress].compress, in[0], fd);
+	close(in[0]);
+	int ok = pid != -1 && editorWriteRows(in[1], state.row, state.textrows) == 0;
+	int err = errno;
+	close(in[1]);
+
+	int status;
+	if(pid != -1){
+		while(waitpid(pid, &status, 0) == -1 && errno == EINTR);
+		if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+			ok = 0;
+			err = EIO;
+		}
+	}
+	sigaction(SIGPIPE, &old, NULL);
+
+	// the compressor shares the offset of the file so it tells how much was written
+	off_t len = lseek(fd, 0, SEEK_CUR);
+	if(ok && (len == -1 || fsync(fd) == -1)){
+		ok = 0;
+		err = errno;
+	}
+	close(fd);
+
+	// the original is only replaced by a complete file, a failed compressor leaves it as it was
+	if(ok && rename(tmp, state.filename) == -1){
+		ok = 0;
+		err = errno;
+	}
+	if(!ok) unlink(tmp);
+	free(tmp);
+
+	errno = err;
+	return ok ? (int)len : -1;
+}
+
+/***JOBS***/
+
+// what is done with the output of a job once its command finished
+enum editorJobKind{
+	JOB_FILTER, // replaces the rows that were fed to it
+	JOB_GREP // goes into a new buffer
+};
+
+// struct to hold a command running in the background on rows of a buffer, the rows are fed to it and its output is collected from the main loop as the pipes allow
+struct editorJob{
+	enum editorJobKind kind;
+	char label[40]; // shown in the status bar while the job runs
+	pid_t pid; // the command
+	int tochild; // write end of the pipe to the command, -1 once all the input is written
+	int fromchild; // read end of the pipe from the command, -1 once it hit eof
+	int status; // exit status of the command once it is done
+	int buf; // buffer whose rows are fed to the command
+	unsigned int before, after; // ids of the rows around the rows fed, 0 for the start or end of the buffer
+	int n; // no. of rows fed
+	unsigned long long hash; // hash of the rows fed, the output only replaces them if they did not change meanwhile
+	struct editorVersion* input; // the rows fed as they were when the job started, so the buffer can be edited meanwhile
+	int inrow; // line of input being written
+	int inoff; // no. of bytes of that line written, its length once only the newline is left
+	size_t inlen; // length of input
+	size_t insent; // no. of bytes of input written so far
+	struct editorRowList out; // rows of the output so far
+	char* carry; // unfinished last line of the output
+	size_t carrylen; // length of carry
+	int shown; // percentage last shown in the status bar
+};
+
+// struct to hold the jobs running in the background
+struct editorJobList{
+	struct editorJob items[YETI_JOBS_MAX]; // the jobs in the order they were started
+	int size; // no. of jobs
+	struct sigaction oldpipe; // how SIGPIPE was handled before the first job started
+	struct{
+		pid_t pid; // the command
+		long long killat; // ms on the monotonic clock it is sent SIGKILL at, 0 once it was
+	} reaps[YETI_JOBS_MAX]; // commands of cancelled jobs that did not exit yet
+	int nreaps; // no. of them
+} jobs;
+
+// func to hash the rows [start, end) of the buffer being edited in order
+unsigned long long editorJobHash(int start, int end){
+	unsigned long long h = YETI_HASH_FIRST;
+	for(int j = start; j < end; j++) h = editorHashPair(h, state.row[j].hash);
+	return h;
+}
+
+// func to start argv in the background on the rows [start, end) of the buffer being edited, returns -1 if it could not be run
+int editorJobStart(enum editorJobKind kind, int start, int end, char* const argv[], const char* label){
+	if(jobs.size == YETI_JOBS_MAX){
+		editorSetStatusMessage("Too many jobs running");
+		return -1;
+	}
+
+	// a command that exits without reading all its input must not kill the editor with SIGPIPE
+	if(jobs.size == 0){
+		struct sigaction ign;
+		memset(&ign, 0, sizeof(ign));
+		ign.sa_handler = SIG_IGN;
+		sigaction(SIGPIPE, &ign, &jobs.oldpipe);
+	}
+
+	int tochild, fromchild;
+	pid_t pid = editorSpawnArgv(argv, &tochild, &fromchild);
+	if(pid == -1){
+		if(jobs.size == 0) sigaction(SIGPIPE, &jobs.oldpipe, NULL);
+		editorSetStatusMessage("Can't run command: %s", strerror(errno));
+		return -1;
+	}
+
+	// the editor keeps going while a pipe is full or empty
+	fcntl(tochild, F_SETFL, O_NONBLOCK);
+	fcntl(fromchild, F_SETFL, O_NONBLOCK);
+
+	struct editorJob* job = &jobs.items[jobs.size++];
+	memset(job, 0, sizeof(*job));
+	job->kind = kind;
+	snprintf(job->label, sizeof(job->label), "%s", label);
+	job->pid = pid;
+	job->tochild = tochild;
+	job->fromchild = fromchild;
+	job->buf = bl.curr;
+	job->before = start > 0 ? state.row[start - 1].id : 0;
+	job->after = end < state.textrows ? state.row[end].id : 0;
+	job->n = end - start;
+	job->hash = editorJobHash(start, end);
+	job->shown = -1;
+
+	for(int j = start; j < end; j++) job->inlen += state.row[j].size + 1;
+	job->input = editorVersionTake(start, end);
+
+	editorSetStatusMessage("Started %s, Ctrl-C cancels it", job->label);
+	return 0;
+}
+
+// func to forget job j, its command is killed if it is still running
+void editorJobFree(int j){
+	struct editorJob* job = &jobs.items[j];
+
+	// the command is collected later so one that is slow to exit does not hold up the editor
+	if(job->pid > 0){
+		kill(job->pid, SIGTERM);
+		if(jobs.nreaps < YETI_JOBS_MAX){
+			jobs.reaps[jobs.nreaps].pid = job->pid;
+			jobs.reaps[jobs.nreaps++].killat = editorNow() + YETI_JOB_KILL_MS;
+			editorTimerStart(TIMER_REAP, YETI_REAP_MS);
+		} else {
+			kill(job->pid, SIGKILL);
+			while(waitpid(job->pid, NULL, 0) == -1 && errno == EINTR);
+		}
+	}
+	if(job->tochild != -1) close(job->tochild);
+	if(job->fromchild != -1) close(job->fromchild);
+	editorVersionRelease(job->input);
+	free(job->carry);
+	editorRowListFree(&job->out);
+
+	memmove(&jobs.items[j], &jobs.items[j + 1], sizeof(struct editorJob) * (jobs.size - j - 1));
+	if(--jobs.size == 0) sigaction(SIGPIPE, &jobs.oldpipe, NULL);
+}
+
+// func to collect the command of a job whose output ended, without blocking unless block is set, returns 1 once it exited
+int editorJobReap(struct editorJob* job, int block){
+	pid_t r;
+	while((r = waitpid(job->pid, &job->status, block ? 0 : WNOHANG)) == -1 && errno == EINTR);
+	if(r == 0) return 0;
+
+	// a command that can not be waited for counts as failed
+	if(r == -1) job->status = -1;
+	job->pid = 0;
+	return 1;
+}
+
+// func run by the reap timer to collect the commands of jobs whose output ended and of cancelled jobs once they exit, the cancelled ones that outlived SIGTERM for YETI_JOB_KILL_MS are sent SIGKILL, returns 1 if a job is done
+int editorReapJobs(){
+	int done = 0, pending = 0;
+	for(int j = 0; j < jobs.size; j++){
+		struct editorJob* job = &jobs.items[j];
+		if(job->fromchild != -1 || job->pid <= 0) continue;
+		if(editorJobReap(job, 0)) done = 1;
+		else pending = 1;
+	}
+
+	long long now = editorNow();
+	for(int j = jobs.nreaps - 1; j >= 0; j--){
+		pid_t r = waitpid(jobs.reaps[j].pid, NULL, WNOHANG);
+		if(r == 0){
+			if(jobs.reaps[j].killat && now >= jobs.reaps[j].killat){
+				kill(jobs.reaps[j].pid, SIGKILL);
+				jobs.reaps[j].killat = 0;
+			}
+			continue;
+		}
+		if(r == -1 && errno == EINTR) continue;
+		jobs.reaps[j] = jobs.reaps[--jobs.nreaps];
+	}
+	if(jobs.nreaps || pending) editorTimerStart(TIMER_REAP, YETI_REAP_MS);
+	return done;
+}
+
+// func to add the pipes of the running jobs to a poll set, returns the no. of entries added, at most 2 * YETI_JOBS_MAX
+int editorJobsPollFds(struct pollfd* fds){
+	int n = 0;
+	for(int j = 0; j < jobs.size; j++){
+		struct editorJob* job = &jobs.items[j];
+		if(job->tochild != -1) fds[n++] = (struct pollfd){job->tochild, POLLOUT, 0};
+		if(job->fromchild != -1) fds[n++] = (struct pollfd){job->fromchild, POLLIN, 0};
+	}
+	return n;
+}
+
+// func to move the data of every job along as far as its pipes allow without blocking, returns 1 if the progress shown in a status bar changed
+int editorRunJobs(){
+	char chunk[YETI_PIPE_CHUNK];
+	int redraw = 0;
+
+	for(int j = 0; j < jobs.size; j++){
+		struct editorJob* job = &jobs.items[j];
+
+		// the input goes out a batch of lines at a time till the pipe is full, a command that stopped reading gets no more of it
+		int stopped = 0;
+		while(job->tochild != -1 && job->insent < job->inlen){
+			ssize_t n = editorVersionWrite(job->tochild, job->input, &job->inrow, &job->inoff);
+			if(n == -1 && errno == EINTR) continue;
+			if(n == -1){
+				stopped = errno != EAGAIN;
+				break;
+			}
+			job->insent += n;
+		}
+
+		// closing the pipe tells the command there is no more input
+		if(job->tochild != -1 && (job->insent == job->inlen || stopped)){
+			close(job->tochild);
+			job->tochild = -1;
+			editorVersionRelease(job->input);
+			job->input = NULL;
+		}
+
+		// the output is read a few chunks at a time so a fast command does not hold up the keys
+		for(int k = 0; k < YETI_JOB_READS && job->fromchild != -1; k++){
+			ssize_t n = read(job->fromchild, chunk, sizeof(chunk));
+			if(n == -1 && errno == EINTR) continue;
+			if(n == -1 && errno == EAGAIN) break;
+			if(n > 0){
+				editorRowListFeed(&job->out, &job->carry, &job->carrylen, chunk, n);
+				continue;
+			}
+
+			// the command is done once its output ends
+			editorRowListEnd(&job->out, &job->carry, &job->carrylen);
+			close(job->fromchild);
+			job->fromchild = -1;
+			if(job->tochild != -1){
+				close(job->tochild);
+				job->tochild = -1;
+			}
+
+			// a command may close its output and go on running, it is then collected by the reap timer so the keys are not held up
+			if(!editorJobReap(job, 0)) editorTimerStart(TIMER_REAP, YETI_REAP_MS);
+			redraw = 1;
+		}
+
+		int percent = job->inlen ? (int)(job->insent * 100 / job->inlen) : 100;
+		if(percent != job->shown){
+			job->shown = percent;
+			redraw = 1;
+		}
+	}
+	return redraw;
+}
+
+// func to check whether a job is done and waits for its output to be used
+int editorJobsDone(){
+	for(int j = 0; j < jobs.size; j++){
+		if(jobs.items[j].pid == 0) return 1;
+	}
+	return 0;
+}
+
+// func to put the output of a filter in place of the rows it was fed, which are looked up by the rows around them, returns -1 if they changed meanwhile
+int editorJobReplace(struct editorJob* job){
+	int start = 0, end = state.textrows;
+	if(job->before){
+		start = editorFindRow(job->before, 0);
+		if(start == -1) return -1;
+		start++;
+	}
+	if(job->after){
+		end = editorFindRow(job->after, start + job->n);
+		if(end == -1) return -1;
+	}
+	if(end - start != job->n || editorJobHash(start, end) != job->hash) return -1;
+
+	editorReplaceRows(start, end, job->out.rows, job->out.n);
+	free(job->out.rows);
+	job->out.rows = NULL;
+	job->out.n = job->out.cap = 0;
+
+	// the editor always holds at least one row
+	if(state.textrows == 0) editorInsertRow(0, "", 0);
+	editorClampCursor();
+	editorAddState();
+	return 0;
+}
+
+// func to show rows in a new unnamed buffer in a window below, the rows are taken from the list even if there is no room for the window
+int editorShowRows(struct editorRowList* list){
+	if(editorSplitWindow(0) == -1){
+		editorRowListFree(list);
+		return -1;
+	}
+	editorNewBuffer();
+	state.row = list->rows;
+	state.textrows = list->n;
+	list->rows = NULL;
+	list->n = list->cap = 0;
+
+	// what is shown is not something to save so it does not count as a change
+	editorRehash();
+	editorMarkSaved();
+	editorAddState();
+	return 0;
+}
+
+// func to use the output of the jobs that are done, called from the main loop so nothing that is being prompted for changes underneath, returns -1 if one of them failed
+int editorFinishJobs(){
+	int failed = 0;
+	for(int j = 0; j < jobs.size; j++){
+		struct editorJob* job = &jobs.items[j];
+		if(job->pid != 0) continue;
+
+		int ok = WIFEXITED(job->status) && WEXITSTATUS(job->status) == 0;
+		if(job->kind == JOB_GREP && WIFEXITED(job->status) && WEXITSTATUS(job->status) == 1){
+			editorSetStatusMessage("%s: no matches", job->label);
+		} else if(!ok){
+			editorSetStatusMessage("%s failed (status %d), nothing replaced", job->label, WIFEXITED(job->status) ? WEXITSTATUS(job->status) : -1);
+			failed = 1;
+		} else if(job->kind == JOB_FILTER){
+			// the rows are replaced in the buffer they came from, which need not be the one being edited now
+			int prev = bl.curr;
+			int rows = job->out.n;
+			editorSwitchBuffer(job->buf);
+			int changed = editorJobReplace(job);
+			editorSwitchBuffer(prev);
+			if(changed == -1) editorSetStatusMessage("%s: the lines changed meanwhile, nothing replaced", job->label);
+			else editorSetStatusMessage("%d lines filtered into %d", job->n, rows);
+			if(changed == -1) failed = 1;
+		} else if(editorShowRows(&job->out) == 0){
+			editorSetStatusMessage("%s: %d matches", job->label, state.textrows);
+		} else failed = 1;
+
+		editorJobFree(j--);
+	}
+	return failed ? -1 : 0;
+}
+
+// func to wait till every job is done and use its output, used where there is no main loop like batch mode, returns -1 if one of them failed
+int editorWaitJobs(){
+	struct pollfd fds[2 * YETI_JOBS_MAX];
+	int failed = 0;
+	while(jobs.size){
+		int n = editorJobsPollFds(fds);
+		if(n && poll(fds, n, -1) == -1 && errno != EINTR) die("poll");
+		editorRunJobs();
+
+		// with every output ended there is nothing to poll, so the commands still running are waited for
+		if(n == 0){
+			for(int j = 0; j < jobs.size; j++) if(jobs.items[j].pid > 0) editorJobReap(&jobs.items[j], 1);
+		}
+		if(editorFinishJobs() == -1) failed = 1;
+	}
+	return failed ? -1 : 0;
+}
+
+// func to cancel the newest job on the buffer being edited, or its diff if no job is running on it
+int editorCancelJob(){
+	for(int j = jobs.size - 1; j >= 0; j--){
+		if(jobs.items[j].buf != bl.curr) continue;
+		editorSetStatusMessage("Cancelled %s", jobs.items[j].label);
+		editorJobFree(j);
+		return 0;
+	}
+	if(bl.buffers[bl.curr].diff){
+		editorPoolCancel(bl.buffers[bl.curr].diff);
+		bl.buffers[bl.curr].diff = NULL;
+		return 0;
+	}
+	editorSetStatusMessage("No job running on this buffer");
+	return -1;
+}
+
+// func to list the running jobs in the status message
+void editorListJobs(){
+	if(jobs.size == 0){
+		editorSetStatusMessage("No jobs running");
+		return;
+	}
+
+	char list[sizeof(state.statusmsg)];
+	int len = 0;
+	for(int j = 0; j < jobs.size && len < (int)sizeof(list); j++){
+		struct editorJob* job = &jobs.items[j];
+		len += snprintf(&list[len], sizeof(list) - len, "%s[%d] %s %d%%", j ? " | " : "", job->buf + 1, job->label, job->shown);
+	}
+	editorSetStatusMessage("%s", list);
+}
+
+// func to show how the pool and the rings its workers hand finished tasks back on are doing, in a new window
+int editorStatsCommand(){
+	struct editorRowList out = {NULL, 0, 0};
+	char line[160];
+	int len = snprintf(line, sizeof(line), "pool: %d workers, %d tasks queued, %d tasks not handed back", pool.size, pool.queued, pool.outstanding);
+	editorRowListAppend(&out, line, len);
+	len = snprintf(line, sizeof(line), "%-8s %10s %8s %11s %12s %12s", "ring", "posted", "waiting", "max waiting", "avg wait ms", "max wait ms");
+	editorRowListAppend(&out, line, len);
+
+	// the counters of the threads are read while they may be changing, which is good enough for a look at how far behind they are
+	for(int j = 0; j <= YETI_MAX_THREADS; j++){
+		struct editorRing* r = &pool.rings[j];
+		unsigned long long posted = __atomic_load_n(&r->posted, __ATOMIC_RELAXED);
+		if(j < YETI_MAX_THREADS && j >= pool.size && posted == 0) continue;
+
+		char name[16];
+		if(j == YETI_MAX_THREADS) snprintf(name, sizeof(name), "main");
+		else snprintf(name, sizeof(name), "worker %d", j + 1);
+		unsigned int waiting = __atomic_load_n(&r->tail, __ATOMIC_RELAXED) - r->head;
+		len = snprintf(line, sizeof(line), "%-8s %10llu %8u %11u %12.3f %12.3f", name, posted, waiting, __atomic_load_n(&r->maxdepth, __ATOMIC_RELAXED), r->taken ? r->waited / 1000.0 / r->taken : 0.0, r->maxwait / 1000.0);
+		editorRowListAppend(&out, line, len);
+	}
+	return editorShowRows(&out);
+}
+
+// func to write the progress of the long edit and the jobs on a buffer for its status bar, returns the length written
+int editorJobStatus(int buf, char* s, int size){
+	int len = 0;
+	s[0] = '\0';
+	if(work.active && work.buf == buf) len += snprintf(s, size, " [%s %d%%]", work.label, work.percent);
+	for(int j = 0; j < jobs.size && len < size; j++){
+		if(jobs.items[j].buf == buf) len += snprintf(&s[len], size - len, " [%.16s %d%%]", jobs.items[j].label, jobs.items[j].shown);
+	}
+	if(len > size - 1) len = size - 1;
+	return len;
+}
+
+// func to fix up the jobs after a buffer was closed, the ones working on it are cancelled
+void editorJobsBufferClosed(int closed){
+	for(int j = jobs.size - 1; j >= 0; j--){
+		if(jobs.items[j].buf == closed) editorJobFree(j);
+		else if(jobs.items[j].buf > closed) jobs.items[j].buf--;
+	}
+}
+
+// func to filter the rows [start, end) through a shell command in the background, batch mode waits for it
+int editorFilterCommand(int start, int end, const char* cmd){
+	while(isspace((unsigned char)*cmd)) cmd++;
+	if(*cmd == '\0'){
+		editorSetStatusMessage("Usage: [range]!command");
+		return -1;
+	}
+
+	char* argv[] = {"/bin/sh", "-c", (char*)cmd, NULL};
+	char label[40];
+	snprintf(label, sizeof(label), "!%s", cmd);
+	if(editorJobStart(JOB_FILTER, start, end, argv, label) == -1) return -1;
+	return batchmode ? editorWaitJobs() : 0;
+}
+
+// func to list the lines of the buffer matching a pattern in a new buffer, grep does the matching in the background
+int editorGrepCommand(const char* pattern){
+	if(*pattern == '\0'){
+		editorSetStatusMessage("Usage: grep pattern");
+		return -1;
+	}
+
+	char* argv[] = {"grep", "-n", "-e", (char*)pattern, NULL};
+	char label[40];
+	snprintf(label, sizeof(label), "grep %s", pattern);
+	if(editorJobStart(JOB_GREP, 0, state.textrows, argv, label) == -1) return -1;
+	return batchmode ? editorWaitJobs() : 0;
+}
+
+/***DIFF***/
+
+// struct to hold one side of a diff, each line is compared by its hash first and its text only when the hashes match
+struct editorDiffSide{
+	const char** text; // start of each line
+	int* len; // length of each line
+	unsigned long long* hash; // hash of each line
+	int n; // no. of lines
+};
+
+// struct to hold one step of the edit script turning the disk lines into the buffer lines
+struct editorDiffOp{
+	char type; // ' ' for a line both have, '-' for a line only on the disk and '+' for a line only in the buffer
+	int a; // index of the disk line, or where the buffer line goes for '+'
+	int b; // index of the buffer line, or where the disk line was for '-'
+};
+
+// func to add a line and its hash to one side of a diff
+void editorDiffAdd(struct editorDiffSide* side, const char* text, int len, unsigned long long hash, int* cap){
+	if(side->n == *cap){
+		*cap = *cap ? *cap * 2 : 1024;
+		side->text = realloc(side->text, sizeof(char*) * *cap);
+		side->len = realloc(side->len, sizeof(int) * *cap);
+		side->hash = realloc(side->hash, sizeof(unsigned long long) * *cap);
+	}
+	side->text[side->n] = text;
+	side->len[side->n] = len;
+	side->hash[side->n] = hash;
+	side->n++;
+}
+
+// func to split text held in memory into the lines of one side of a diff, the lines point into the text
+void editorDiffSplit(struct editorDiffSide* side, const char* text, size_t len){
+	int cap = 0;
+	const char* p = text;
+	const char* end = text + len;
+	while(p < end){
+		const char* nl = memchr(p, '\n', end - p);
+		if(nl == NULL) nl = end;
+		int linelen = nl - p;
+		while(linelen > 0 && p[linelen - 1] == '\r') linelen--;
+		editorDiffAdd(side, p, linelen, editorHashBytes(p, linelen), &cap);
+		p = nl + 1;
+	}
+}
+
+// func to free the arrays of one side of a diff
+void editorDiffFree(struct editorDiffSide* side){
+	free(side->text);
+	free(side->len);
+	free(side->hash);
+}
+
+// func to check whether line i of a and line j of b are the same
+int editorDiffEqual(struct editorDiffSide* a, int i, struct editorDiffSide* b, int j){
+	return a->hash[i] == b->hash[j] && a->len[i] == b->len[j] && memcmp(a->text[i], b->text[j], a->len[i]) == 0;
+}
+
+// func to append a step to the edit script
+void editorDiffPush(struct editorDiffOp* ops, int* nops, char type, int a, int b){
+	ops[*nops].type = type;
+	ops[*nops].a = a;
+	ops[*nops].b = b;
+	(*nops)++;
+}
+
+// func to find the shortest edit script between the lines [alo, ahi) of a and [blo, bhi) of b with the myers algorithm and append it to ops, returns -1 if it needs more than YETI_DIFF_MAX_EDITS edits
+int editorDiffMyers(struct editorDiffSide* a, int alo, int ahi, struct editorDiffSide* b, int blo, int bhi, struct editorDiffOp* ops, int* nops){
+	int n = ahi - alo, m = bhi - blo;
+	int max = n + m < YETI_DIFF_MAX_EDITS ? n + m : YETI_DIFF_MAX_EDITS;
+
+	// v holds the furthest x reached on each diagonal k = x - y, the trace keeps its window [-d, d] after each round d for the walk back
+	int* v = malloc(sizeof(int) * (2 * max + 3));
+	int* trace = NULL;
+	size_t tracelen = 0;
+	int offset = max + 1;
+	v[offset + 1] = 0;
+
+	int found = -1;
+	for(int d = 0; d <= max && found == -1; d++){
+		for(int k = -d; k <= d; k += 2){
+			int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) ? v[offset + k + 1] : v[offset + k - 1] + 1;
+			int y = x - k;
+
+			// follow the diagonal while the lines match
+			while(x < n && y < m && editorDiffEqual(a, alo + x, b, blo + y)){
+				x++;
+				y++;
+			}
+			v[offset + k] = x;
+			if(x >= n && y >= m) found = d;
+		}
+		trace = realloc(trace, sizeof(int) * (tracelen + 2 * d + 1));
+		memcpy(&trace[tracelen], &v[offset - d], sizeof(int) * (2 * d + 1));
+		tracelen += 2 * d + 1;
+	}
+	free(v);
+	if(found == -1){
+		free(trace);
+		return -1;
+	}
+
+	// walk back from the end collecting the steps in reverse
+	int start = *nops;
+	int x = n, y = m;
+	for(int d = found; d > 0; d--){
+		size_t prev = (size_t)(d - 1) * (d - 1);
+		int k = x - y;
+		int prevk = (k == -d || (k != d && trace[prev + (k - 1) + (d - 1)] < trace[prev + (k + 1) + (d - 1)])) ? k + 1 : k - 1;
+		int prevx = trace[prev + prevk + (d - 1)];
+		int prevy = prevx - prevk;
+
+		while(x > prevx && y > prevy){
+			x--;
+			y--;
+			editorDiffPush(ops, nops, ' ', alo + x, blo + y);
+		}
+		if(x == prevx) editorDiffPush(ops, nops, '+', alo + x, blo + prevy);
+		else editorDiffPush(ops, nops, '-', alo + prevx, blo + y);
+		x = prevx;
+		y = prevy;
+	}
+	while(x > 0 && y > 0){
+		x--;
+		y--;
+		editorDiffPush(ops, nops, ' ', alo + x, blo + y);
+	}
+	free(trace);
+
+	// put the steps in order
+	for(int i = start, j = *nops - 1; i < j; i++, j--){
+		struct editorDiffOp tmp = ops[i];
+		ops[i] = ops[j];
+		ops[j] = tmp;
+	}
+	return 0;
+}
+
+// func to build the edit script between a and b, the lines both start and end with are skipped before the search so a few changes in a large file are found quickly, returns the no. of steps
+int editorDiff(struct editorDiffSide* a, struct editorDiffSide* b, struct editorDiffOp* ops, int* toolarge){
+	int nops = 0;
+	int pre = 0;
+	while(pre < a->n && pre < b->n && editorDiffEqual(a, pre, b, pre)) pre++;
+	int suf = 0;
+	while(suf < a->n - pre && suf < b->n - pre && editorDiffEqual(a, a->n - 1 - suf, b, b->n - 1 - suf)) suf++;
+
+	for(int j = 0; j < pre; j++) editorDiffPush(ops, &nops, ' ', j, j);
+
+	// too many changes are shown as the old lines replaced by the new ones
+	*toolarge = editorDiffMyers(a, pre, a->n - suf, b, pre, b->n - suf, ops, &nops) == -1;
+	if(*toolarge){
+		for(int j = pre; j < a->n - suf; j++) editorDiffPush(ops, &nops, '-', j, pre);
+		for(int j = pre; j < b->n - suf; j++) editorDiffPush(ops, &nops, '+', a->n - suf, j);
+	}
+
+	for(int j = suf; j > 0; j--) editorDiffPush(ops, &nops, ' ', a->n - j, b->n - j);
+	return nops;
+}
+
+// func to append a line of the diff output to a row list
+void editorDiffLine(struct editorRowList* out, char type, const char* text, int len){
+	char* line = malloc(len + 2);
+	line[0] = type;
+	memcpy(line + 1, text, len);
+	editorRowListAppend(out, line, len + 1);
+	free(line);
+}
+
+// func to turn the edit script into unified diff hunks with YETI_DIFF_CONTEXT lines of context around the changes
+void editorDiffFormat(struct editorDiffSide* a, struct editorDiffSide* b, struct editorDiffOp* ops, int nops, struct editorRowList* out){
+	int i = 0;
+	while(i < nops){
+		// find the next change and the end of the hunk, changes closer than twice the context share a hunk
+		while(i < nops && ops[i].type == ' ') i++;
+		if(i == nops) break;
+		int first = i, last = i;
+		for(int j = i + 1; j < nops && j <= last + 2 * YETI_DIFF_CONTEXT; j++){
+			if(ops[j].type != ' ') last = j;
+		}
+		int hs = first > YETI_DIFF_CONTEXT ? first - YETI_DIFF_CONTEXT : 0;
+		int he = last + 1 + YETI_DIFF_CONTEXT < nops ? last + 1 + YETI_DIFF_CONTEXT : nops;
+
+		int acount = 0, bcount = 0;
+		for(int j = hs; j < he; j++){
+			if(ops[j].type != '+') acount++;
+			if(ops[j].type != '-') bcount++;
+		}
+		char header[96];
+		int len = snprintf(header, sizeof(header), "@@ -%d,%d +%d,%d @@", acount ? ops[hs].a + 1 : ops[hs].a, acount, bcount ? ops[hs].b + 1 : ops[hs].b, bcount);
+		editorRowListAppend(out, header, len);
+
+		for(int j = hs; j < he; j++){
+			if(ops[j].type == '+') editorDiffLine(out, '+', b->text[ops[j].b], b->len[ops[j].b]);
+			else editorDiffLine(out, ops[j].type, a->text[ops[j].a], a->len[ops[j].a]);
+		}
+		i = he;
+	}
+}
+
+// func to read everything from fd into a malloced buffer, returns NULL on failure
+char* editorReadAll(int fd, size_t* len){
+	size_t cap = YETI_PIPE_CHUNK;
+	char* buf = malloc(cap);
+	*len = 0;
+	while(1){
+		if(*len == cap){
+			cap *= 2;
+			buf = realloc(buf, cap);
+		}
+		ssize_t n = read(fd, buf + *len, cap - *len);
+		if(n == -1 && errno == EINTR) continue;
+		if(n == -1){
+			free(buf);
+			return NULL;
+		}
+		if(n == 0) return buf;
+		*len += n;
+	}
+}
+
+// struct to hold a diff worked out on the pool, the disk is read and compared with a version of the buffer off the main thread
+struct editorDiffTask{
+	struct editorTask task; // the task queued on the pool, first so the task is the diff task
+	struct editorVersion* version; // the buffer when the diff was asked for
+	char* filename; // file compared with
+	int compress; // codec the file is read through
+	char* disk; // text of the file
+	size_t disklen; // length of the text of the file
+	int mapped; // set if the text of the file is mapped rather than malloced
+	struct editorDiffSide a, b; // the disk and buffer lines
+	struct editorDiffOp* ops; // the edit script
+	int nops; // no. of steps in the edit script
+	int toolarge; // set if the changes were too many to match up
+	int err; // errno of a failed open, -1 if the file could not be read
+};
+
+// func to read the file and build the edit script, run by the pool
+void editorDiffRun(struct editorTask* t){
+	struct editorDiffTask* d = (struct editorDiffTask*)t;
+
+	int fd = open(d->filename, O_RDONLY | O_CLOEXEC);
+	if(fd == -1){
+		d->err = errno;
+		return;
+	}
+
+	// the disk side is read through the decompressor for a compressed file and mapped otherwise
+	if(d->compress != COMPRESS_NONE){
+		int out[2];
+		if(pipe2(out, O_CLOEXEC) == 0){
+			pid_t pid = editorSpawnCodec(codecs[d->compress].decompress, fd, out[1]);
+			close(out[1]);
+			if(pid != -1){
+				d->disk = editorReadAll(out[0], &d->disklen);
+				while(waitpid(pid, NULL, 0) == -1 && errno == EINTR);
+			}
+			close(out[0]);
+		}
+	} else {
+		struct stat st;
+		if(fstat(fd, &st) == 0 && st.st_size > 0){
+			d->disk = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			d->disklen = st.st_size;
+			d->mapped = d->disk != MAP_FAILED;
+			if(!d->mapped) d->disk = NULL;
+		} else d->disk = editorReadAll(fd, &d->disklen);
+	}
+	close(fd);
+	if(d->disk == NULL || editorTaskCancelled(t)){
+		d->err = -1;
+		return;
+	}
+
+	editorDiffSplit(&d->a, d->disk, d->disklen);
+	int cap = 0;
+	for(int j = 0; j < d->version->n; j++){
+		struct editorLine* line = d->version->lines[j];
+		editorDiffAdd(&d->b, line->text, line->len, line->hash, &cap);
+	}
+
+	// an empty buffer still holds one empty row, which the empty file does not have
+	if(d->b.n == 1 && d->b.len[0] == 0 && d->a.n == 0) d->b.n = 0;
+
+	d->ops = malloc(sizeof(struct editorDiffOp) * (d->a.n + d->b.n + 1));
+	d->nops = editorDiff(&d->a, &d->b, d->ops, &d->toolarge);
+}
+
+// func to show the diff in a new window once the pool is done with it, the rows are made here since their ids come from the main thread
+void editorDiffDone(struct editorTask* t){
+	struct editorDiffTask* d = (struct editorDiffTask*)t;
+	struct editorRowList out = {NULL, 0, 0};
+	for(int j = 0; j < bl.size; j++) if(bl.buffers[j].diff == t) bl.buffers[j].diff = NULL;
+
+	if(editorTaskCancelled(t)) editorSetStatusMessage("Diff cancelled");
+	else if(d->err > 0) editorSetStatusMessage("Can't open %s: %s", d->filename, strerror(d->err));
+	else if(d->err) editorSetStatusMessage("Can't read %s", d->filename);
+	else {
+		char header[256];
+		int len = snprintf(header, sizeof(header), "--- %s (disk)", d->filename);
+		editorRowListAppend(&out, header, len < (int)sizeof(header) ? len : (int)sizeof(header) - 1);
+		len = snprintf(header, sizeof(header), "+++ %s (buffer)", d->filename);
+		editorRowListAppend(&out, header, len < (int)sizeof(header) ? len : (int)sizeof(header) - 1);
+		editorDiffFormat(&d->a, &d->b, d->ops, d->nops, &out);
+		if(out.n == 2) editorSetStatusMessage("No changes");
+	}
+
+	int toolarge = d->toolarge;
+	free(d->ops);
+	editorDiffFree(&d->a);
+	editorDiffFree(&d->b);
+	if(d->mapped) munmap(d->disk, d->disklen);
+	else free(d->disk);
+	editorVersionRelease(d->version);
+	free(d->filename);
+	free(d);
+
+	// the diff goes into a new unnamed buffer in a window below
+	if(out.n <= 2){
+		editorRowListFree(&out);
+		return;
+	}
+	if(editorShowRows(&out) == -1) return;
+	if(toolarge) editorSetStatusMessage("Too many changes to match up, shown as a replacement");
+}
+
+// func to show what changed between the file on the disk and the buffer being edited as a unified diff in a new window, the work is done on the pool while editing goes on
+int editorDiffCommand(){
+	if(state.filename == NULL){
+		editorSetStatusMessage("No file to compare with");
+		return -1;
+	}
+
+	struct editorDiffTask* d = calloc(1, sizeof(struct editorDiffTask));
+	d->task.run = editorDiffRun;
+	d->task.done = editorDiffDone;
+	d->filename = strdup(state.filename);
+	d->compress = state.compress;
+	d->version = editorVersionTake(0, state.textrows);
+	bl.buffers[bl.curr].diff = &d->task;
+	editorPoolSubmit(&d->task);
+
+	// batch mode has no main loop to hand the diff back
+	if(batchmode) editorPoolWait();
+	return 0;
+}
+
+/***EDIT COMMANDS***/
+
+// func to move the cursor to the start of the given line (counted from 1)
+void editorGotoLine(int line){
+	editorJumpPush(state.cy, state.cx);
+	state.cy = line - 1;
+	state.cx = state.linenooff;
+	editorClampCursor();
+}
+
+// func to search for the query from just after the cursor, wrapping around the end of the file, returns -1 if there is no match
+int editorSearchForward(const char* query){
+	size_t qlen = strlen(query);
+	if(qlen == 0) return -1;
+
+	for(int i = 0; i <= state.textrows; i++){
+		int r = (state.cy + i) % state.textrows;
+		erow* row = &state.row[r];
+
+		// the cursor row is searched from after the cursor on the first pass and up to it on the wrapped pass
+		int from = 0;
+		if(i == 0) from = state.cx - state.linenooff + 1;
+		if(from > row->size) continue;
+
+		char* match = memmem(row->text + from, row->size - from, query, qlen);
+		if(match){
+			editorJumpPush(state.cy, state.cx);
+			state.cy = r;
+			state.cx = (match - row->text) + state.linenooff;
+			return 0;
+		}
+	}
+
+	editorSetStatusMessage("Pattern not found: %s", query);
+	return -1;
+}
+
+// func to replace the occurrences of old in a row, only the first one unless global is set, returns the no. of replacements
+int editorRowReplace(erow* row, const char* old, size_t oldlen, const char* new, size_t newlen, int global){
+	// count the matches first so the new text is built with a single allocation
+	int count = 0;
+	char* p = row->text;
+	char* end = row->text + row->size;
+	char* m;
+	while((m = memmem(p, end - p, old, oldlen)) != NULL){
+		count++;
+		p = m + oldlen;
+		if(!global) break;
+	}
+	if(count == 0) return 0;
+
+	int size = row->size + count * ((int)newlen - (int)oldlen);
+	char* text = malloc(size + 1);
+	char* w = text;
+	p = row->text;
+	for(int i = 0; i < count; i++){
+		m = memmem(p, end - p, old, oldlen);
+		memcpy(w, p, m - p);
+		w += m - p;
+		memcpy(w, new, newlen);
+		w += newlen;
+		p = m + oldlen;
+	}
+	memcpy(w, p, end - p);
+	text[size] = '\0';
+
+	free(row->text);
+	row->text = text;
+	row->size = size;
+	editorUpdateRow(row);
+	return count;
+}
+
+// func to run the substitution under way on row j, returns the no. of replacements
+int editorSubstituteRow(int j){
+	return editorRowReplace(&state.row[j], work.old, work.oldlen, work.new, work.newlen, work.global);
+}
+
+// func to run a substitution of the form /old/new/[g] (any delimiter) over the rows [start, end), a large range is done a slice at a time between keys, returns -1 on a malformed command
+int editorSubstitute(int start, int end, char* args){
+	char delim = *args;
+	if(delim == '\0' || isalnum((unsigned char)delim) || isspace((unsigned char)delim)){
+		editorSetStatusMessage("Usage: [range]s/old/new/[g]");
+		return -1;
+	}
+
+	// cut the pattern, the replacement and the flags apart
+	char* old = args + 1;
+	char* new = strchr(old, delim);
+	if(new == NULL || new == old){
+		editorSetStatusMessage("Usage: [range]s/old/new/[g]");
+		return -1;
+	}
+	*new++ = '\0';
+	char* flags = strchr(new, delim);
+	if(flags) *flags++ = '\0';
+	int global = flags && strchr(flags, 'g');
+
+	// the command line is gone by the time the later slices run
+	work.old = strdup(old);
+	work.oldlen = strlen(old);
+	work.new = strdup(new);
+	work.newlen = strlen(new);
+	work.global = global;
+	work.start = work.next = start;
+	work.end = end;
+	work.step = editorWorkRows;
+	work.finish = editorWorkRowsFinish;
+	work.row = editorSubstituteRow;
+	work.what = "replacements";
+	editorWorkStart("substitute");
+	return 0;
+}
+
+// func to delete the rows [start, end)
+void editorDeleteLines(int start, int end){
+	if(end <= start) return;
+
+	editorReplaceRows(start, end, NULL, 0);
+
+	// the editor always holds at least one row
+	if(state.textrows == 0) editorInsertRow(0, "", 0);
+	editorClampCursor();
+
+	editorAddState();
+	editorSetStatusMessage("%d lines deleted", end - start);
+}
+
+// func to insert a line of text before the given row and move the cursor to it
+void editorInsertLine(int at, const char* text){
+	if(at < 0) at = 0;
+	if(at > state.textrows) at = state.textrows;
+
+	editorInsertRow(at, (char*)text, strlen(text));
+	state.cy = at;
+	state.cx = state.linenooff;
+
+	editorAddState();
+}
+
+// func to write the whole text to stdout
+int editorPrintLines(){
+	if(editorWriteRows(STDOUT_FILENO, state.row, state.textrows) == -1){
+		editorSetStatusMessage("Can't write to stdout: %s", strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+// func to save the text, under a new name if one is given
+int editorSaveAs(const char* filename){
+	if(*filename){
+		free(state.filename);
+		state.filename = strdup(filename);
+	}
+	return editorSave();
+}
+
+// func to switch an option on ("set name") or off ("set noname")
+int editorSetOption(const char* args){
+	// table of the options that can be set
+	struct { const char* name; int* value; } options[] = {
+		{"autoindent", &opts.autoindent},
+		{"trimonsave", &opts.trimonsave},
+		{"expandonsave", &opts.expandonsave},
+		{"unexpandonsave", &opts.unexpandonsave},
+		{"esctimeout", &opts.esctimeout},
+	};
+
+	// name=value sets a number, else the name switches the option on and noname off
+	int value = 1;
+	size_t namelen = strcspn(args, "=");
+	if(args[namelen] == '='){
+		value = atoi(&args[namelen + 1]);
+		if(value < 0) value = 0;
+	} else if(strncmp(args, "no", 2) == 0){
+		value = 0;
+		args += 2;
+		namelen -= 2;
+	}
+
+	for(size_t j = 0; j < sizeof(options) / sizeof(options[0]); j++){
+		if(strlen(options[j].name) == namelen && strncmp(args, options[j].name, namelen) == 0){
+			*options[j].value = value;
+			if(args[namelen] == '=') editorSetStatusMessage("%s=%d", options[j].name, value);
+			else editorSetStatusMessage("%s%s", value ? "" : "no", options[j].name);
+			return 0;
+		}
+	}
+
+	editorSetStatusMessage("Unknown option: %s", args);
+	return -1;
+}
+
+/***MARKS***/
+
+// func to find the row with the given id looking outwards from the line it was last seen at, a mark only pays for the rows inserted or deleted between them, returns -1 if the row is gone
+int editorFindRow(unsigned int id, int line){
+	if(line >= state.textrows) line = state.textrows - 1;
+	if(line < 0) line = 0;
+
+	for(int d = 0; line - d >= 0 || line + d < state.textrows; d++){
+		if(line + d < state.textrows && state.row[line + d].id == id) return line + d;
+		if(line - d >= 0 && state.row[line - d].id == id) return line - d;
+	}
+	return -1;
+}
+
+// func to set a mark to a position of the buffer being edited
+void editorMarkAt(struct editorMark* m, int cy, int cx){
+	m->buf = bl.curr;
+	m->id = state.row[cy].id;
+	m->line = cy;
+	m->col = cx - state.linenooff;
+	if(m->col < 0) m->col = 0;
+}
+
+// func to move the cursor to a mark, to the line its row was last seen at if the row was deleted
+void editorMarkGoto(struct editorMark* m){
+	editorSwitchBuffer(m->buf);
+
+	int line = editorFindRow(m->id, m->line);
+	if(line != -1) m->line = line;
+
+	state.cy = m->line;
+	editorClampCursor();
+	int size = state.row[state.cy].size;
+	state.cx = state.linenooff + (m->col < size ? m->col : size);
+}
+
+// func to check whether two marks are at the same position
+int editorMarkSame(const struct editorMark* a, const struct editorMark* b){
+	return a->buf == b->buf && a->id == b->id && a->col == b->col;
+}
+
+// func to add a position to the end of the jump list, the oldest one is dropped once it is full
+void editorJumpAppend(struct editorMark* m){
+	if(jumps.size == YETI_JUMPS_MAX){
+		memmove(&jumps.items[0], &jumps.items[1], sizeof(struct editorMark) * --jumps.size);
+		if(jumps.curr > 0) jumps.curr--;
+	}
+	jumps.items = realloc(jumps.items, sizeof(struct editorMark) * (jumps.size + 1));
+	jumps.items[jumps.size++] = *m;
+}
+
+// func to remember a position of the buffer being edited before the cursor jumps away from it, the positions jumped back over are dropped like the redo of an edit
+void editorJumpPush(int cy, int cx){
+	if(state.textrows == 0) return;
+
+	struct editorMark m;
+	editorMarkAt(&m, cy, cx);
+
+	jumps.size = jumps.curr;
+	if(jumps.size == 0 || !editorMarkSame(&jumps.items[jumps.size - 1], &m)) editorJumpAppend(&m);
+	jumps.curr = jumps.size;
+}
+
+// func to go back to the position jumped from
+void editorJumpBack(){
+	// the position left is remembered first so a forward jump can come back to it
+	if(jumps.curr == jumps.size){
+		struct editorMark here;
+		editorMarkAt(&here, state.cy, state.cx);
+		if(jumps.size && editorMarkSame(&jumps.items[jumps.size - 1], &here)) jumps.curr = jumps.size - 1;
+		else editorJumpAppend(&here);
+	}
+
+	if(jumps.curr == 0){
+		editorSetStatusMessage("At the start of the jump list");
+		return;
+	}
+	editorMarkGoto(&jumps.items[--jumps.curr]);
+}
+
+// func to go forward again to a position jumped back from
+void editorJumpForward(){
+	if(jumps.curr + 1 >= jumps.size){
+		editorSetStatusMessage("At the end of the jump list");
+		return;
+	}
+	editorMarkGoto(&jumps.items[++jumps.curr]);
+}
+
+// func to fix up the jump list after a buffer was closed, its positions are dropped
+void editorJumpsBufferClosed(int closed){
+	int w = 0;
+	for(int r = 0; r < jumps.size; r++){
+		if(jumps.items[r].buf == closed){
+			if(r < jumps.curr) jumps.curr--;
+			continue;
+		}
+		jumps.items[w] = jumps.items[r];
+		if(jumps.items[w].buf > closed) jumps.items[w].buf--;
+		w++;
+	}
+	jumps.size = w;
+}
+
+// func to get the mark of the buffer being edited with the given name, returns NULL for a name that is not a to z
+struct editorMark* editorNamedMark(const char* name){
+	if(name[0] < 'a' || name[0] > 'z' || name[1] != '\0'){
+		editorSetStatusMessage("Marks are named a to z");
+		return NULL;
+	}
+	return &bl.buffers[bl.curr].marks[name[0] - 'a'];
+}
+
+// func to set a named mark to the cursor
+int editorSetMark(const char* name){
+	struct editorMark* m = editorNamedMark(name);
+	if(m == NULL) return -1;
+	editorMarkAt(m, state.cy, state.cx);
+	editorSetStatusMessage("Mark %s set", name);
+	return 0;
+}
+
+// func to jump to a named mark
+int editorGotoMark(const char* name){
+	struct editorMark* m = editorNamedMark(name);
+	if(m == NULL) return -1;
+	if(m->id == 0){
+		editorSetStatusMessage("Mark %s not set", name);
+		return -1;
+	}
+
+	// the slot moves with the buffer when one before it is closed so the index stored with it may be stale
+	m->buf = bl.curr;
+	editorJumpPush(state.cy, state.cx);
+	editorMarkGoto(m);
+	return 0;
+}
+
+// func to list the set marks of the buffer being edited with the lines they are on
+void editorListMarks(){
+	char list[sizeof(state.statusmsg)];
+	int len = 0;
+	for(int j = 0; j < YETI_MARKS && len < (int)sizeof(list); j++){
+		struct editorMark* m = &bl.buffers[bl.curr].marks[j];
+		if(m->id == 0) continue;
+		int line = editorFindRow(m->id, m->line);
+		if(line != -1) m->line = line;
+		len += snprintf(&list[len], sizeof(list) - len, "%s%c:%d", len ? " " : "", 'a' + j, m->line + 1);
+	}
+	editorSetStatusMessage("%s", len ? list : "No marks set");
+}
+
+/***COMMANDS***/
+
+// func to read a line address (a line no., '.' for the current line or '$' for the last line), returns -1 if there is none
+int editorParseLineAddr(char** p){
+	if(**p == '.'){
+		(*p)++;
+		return state.cy + 1;
+	}
+	if(**p == '$'){
+		(*p)++;
+		return state.textrows;
+	}
+	if(isdigit((unsigned char)**p)) return (int)strtol(*p, p, 10);
+	return -1;
+}
+
+// func to parse the optional range in front of a command ("%", "n" or "n,m"), the rows are returned as [start, end) and default to the whole file
+int editorParseRange(char** p, int* start, int* end){
+	*start = 0;
+	*end = state.textrows;
+
+	if(**p == '%'){
+		(*p)++;
+		return 1;
+	}
+
+	int a = editorParseLineAddr(p);
+	if(a == -1) return 0;
+
+	int b = a;
+	if(**p == ','){
+		(*p)++;
+		b = editorParseLineAddr(p);
+		if(b == -1) b = state.textrows;
+	}
+
+	// keep the range inside the file
+	if(a > b){
+		int t = a;
+		a = b;
+		b = t;
+	}
+	if(a < 1) a = 1;
+	if(b > state.textrows) b = state.textrows;
+
+	// a range starting past the end is left empty instead of running backwards
+	if(a > b + 1) a = b + 1;
+
+	*start = a - 1;
+	*end = b;
+	return 1;
+}
+
+// func to check if the command name typed matches the given word
+int editorCommandIs(const char* name, int len, const char* word){
+	return (int)strlen(word) == len && strncmp(name, word, len) == 0;
+}
+
+// struct to hold a command line split up by the parser
+struct editorCommandLine{
+	int start, end; // rows a line command works on, the whole file without a range
+	int lstart, lend; // rows an edit command works on, the current line without a range
+	int ranged; // set if a range was typed
+	char* rest; // what follows the name as typed
+	char* args; // the arguments, rest without the space after the name
+};
+
+// what each command of the command line does
+enum editorCommandId{
+	CMD_QUIT,
+	CMD_UNDO,
+	CMD_SORT,
+	CMD_UNIQ,
+	CMD_REVERSE,
+	CMD_FILTER,
+	CMD_GREP,
+	CMD_SEARCH,
+	CMD_GOTO,
+	CMD_SUBSTITUTE,
+	CMD_DELETE,
+	CMD_INSERT,
+	CMD_APPEND,
+	CMD_SAVE,
+	CMD_PRINT,
+	CMD_INDENT,
+	CMD_DEDENT,
+	CMD_SET,
+	CMD_EDIT,
+	CMD_BUFFER,
+	CMD_NEXT_BUFFER,
+	CMD_PREV_BUFFER,
+	CMD_CLOSE_BUFFER,
+	CMD_BUFFERS,
+	CMD_SPLIT,
+	CMD_VSPLIT,
+	CMD_CLOSE,
+	CMD_DIFF,
+	CMD_MARK,
+	CMD_GOTO_MARK,
+	CMD_MARKS,
+	CMD_TRIM,
+	CMD_EXPAND,
+	CMD_UNEXPAND,
+	CMD_JOBS,
+	CMD_CANCEL,
+	CMD_STATS
+};
+
+// struct to hold a command of the command line
+struct editorCommand{
+	const char* name; // the name, which is also what is completed, or the sign a sign command starts with
+	const char* alias; // a short name, NULL if there is none
+	enum editorCommandId id; // what the command does
+	int file; // set if the argument is a file name, which is completed as such
+};
+
+// the commands of the command line
+static const struct editorCommand editorCommands[] = {
+	{"quit", "q", CMD_QUIT, 0},
+	{"undo", "u", CMD_UNDO, 0},
+	{"sort", NULL, CMD_SORT, 0},
+	{"uniq", NULL, CMD_UNIQ, 0},
+	{"reverse", "rev", CMD_REVERSE, 0},
+	{"!", NULL, CMD_FILTER, 0},
+	{"grep", NULL, CMD_GREP, 0},
+	{"/", NULL, CMD_SEARCH, 0},
+	{"goto", NULL, CMD_GOTO, 0},
+	{"s", NULL, CMD_SUBSTITUTE, 0},
+	{"delete", "d", CMD_DELETE, 0},
+	{"insert", "i", CMD_INSERT, 0},
+	{"append", "a", CMD_APPEND, 0},
+	{"save", "w", CMD_SAVE, 1},
+	{"print", "p", CMD_PRINT, 0},
+	{">", NULL, CMD_INDENT, 0},
+	{"<", NULL, CMD_DEDENT, 0},
+	{"set", NULL, CMD_SET, 0},
+	{"edit", "e", CMD_EDIT, 1},
+	{"buffer", "b", CMD_BUFFER, 0},
+	{"bn", NULL, CMD_NEXT_BUFFER, 0},
+	{"bp", NULL, CMD_PREV_BUFFER, 0},
+	{"bd", NULL, CMD_CLOSE_BUFFER, 0},
+	{"buffers", "ls", CMD_BUFFERS, 0},
+	{"split", "sp", CMD_SPLIT, 1},
+	{"vsplit", "vs", CMD_VSPLIT, 1},
+	{"close", NULL, CMD_CLOSE, 0},
+	{"diff", NULL, CMD_DIFF, 0},
+	{"mark", "k", CMD_MARK, 0},
+	{"'", NULL, CMD_GOTO_MARK, 0},
+	{"marks", NULL, CMD_MARKS, 0},
+	{"trim", NULL, CMD_TRIM, 0},
+	{"expand", NULL, CMD_EXPAND, 0},
+	{"unexpand", NULL, CMD_UNEXPAND, 0},
+	{"jobs", NULL, CMD_JOBS, 0},
+	{"cancel", NULL, CMD_CANCEL, 0},
+	{"stats", NULL, CMD_STATS, 0}
+};
+
+#define YETI_COMMANDS (int)(sizeof(editorCommands) / sizeof(editorCommands[0]))
+
+// func to find the command with the given name or alias, returns NULL if there is none
+const struct editorCommand* editorFindCommand(const char* name, int len){
+	for(int j = 0; j < YETI_COMMANDS; j++){
+		const struct editorCommand* cmd = &editorCommands[j];
+		if(editorCommandIs(name, len, cmd->name) || (cmd->alias && editorCommandIs(name, len, cmd->alias))) return cmd;
+	}
+	return NULL;
+}
+
+// func to split a command line into its range, name and arguments, the name is the letters after the range or the sign of a sign command, returns the length of the name
+int editorParseCommand(char* command, struct editorCommandLine* c, char** name){
+	char* p = command;
+	while(isspace((unsigned char)*p)) p++;
+
+	// the optional range the command works on, line commands default to the whole file and edit commands to the current line
+	c->ranged = editorParseRange(&p, &c->start, &c->end);
+	c->lstart = c->ranged ? c->start : state.cy;
+	c->lend = c->ranged ? c->end : state.cy + 1;
+	while(isspace((unsigned char)*p)) p++;
+
+	*name = p;
+	while(isalpha((unsigned char)*p)) p++;
+	if(p == *name && *p && strchr("!/<>'", *p)) p++;
+	int len = p - *name;
+
+	// the arguments follow the name, a sign is followed by them straight away
+	c->rest = p;
+	c->args = p;
+	if(len && *p == ' ' && isalpha((unsigned char)**name)) c->args++;
+	return len;
+}
+
+// func to run a command typed in the command prompt or read from a batch script, returns -1 if the command failed
+int editorRunCommand(char* command){
+	struct editorCommandLine c;
+	char* name;
+	int len = editorParseCommand(command, &c, &name);
+
+	// a bare line no. moves the cursor to that line
+	if(len == 0 && *c.rest == '\0'){
+		if(c.ranged) editorGotoLine(c.end);
+		return 0;
+	}
+
+	const struct editorCommand* cmd = editorFindCommand(name, len);
+	if(cmd == NULL){
+		editorSetStatusMessage("Unknown command: %s", command);
+		return -1;
+	}
+
+	switch(cmd->id){
+		case CMD_QUIT: editorQuit(); break;
+		case CMD_UNDO:
+			// batch mode records no undo states
+			if(batchmode){
+				editorSetStatusMessage("Undo is not available in batch mode");
+				return -1;
+			}
+			editorUndoState();
+			break;
+		case CMD_SORT: editorSortLines(c.start, c.end); break;
+		case CMD_UNIQ: editorUniqLines(c.start, c.end); break;
+		case CMD_REVERSE: editorReverseLines(c.start, c.end); break;
+		case CMD_FILTER: return editorFilterCommand(c.start, c.end, c.args);
+		case CMD_GREP: return editorGrepCommand(c.args);
+		case CMD_SEARCH: return editorSearchForward(c.args);
+		case CMD_GOTO: editorGotoLine(atoi(c.args)); break;
+		case CMD_SUBSTITUTE: return editorSubstitute(c.lstart, c.lend, c.rest);
+		case CMD_DELETE: editorDeleteLines(c.lstart, c.lend); break;
+		case CMD_INSERT: editorInsertLine(c.lstart, c.args); break;
+		case CMD_APPEND: editorInsertLine(c.lend, c.args); break;
+		case CMD_SAVE: return editorSaveAs(c.args);
+		case CMD_PRINT: return editorPrintLines();
+		case CMD_INDENT: editorIndentLines(c.lstart, c.lend); break;
+		case CMD_DEDENT: editorDedentLines(c.lstart, c.lend); break;
+		case CMD_SET: return editorSetOption(c.args);
+		case CMD_EDIT: return editorOpen(c.args) == -1 ? -1 : 0;
+		case CMD_BUFFER: return editorGotoBuffer(atoi(c.args) - 1);
+		case CMD_NEXT_BUFFER: return editorGotoBuffer((bl.curr + 1) % bl.size);
+		case CMD_PREV_BUFFER: return editorGotoBuffer((bl.curr + bl.size - 1) % bl.size);
+		case CMD_CLOSE_BUFFER: return editorCloseBuffer();
+		case CMD_BUFFERS: editorListBuffers(); break;
+		case CMD_SPLIT: return editorSplitCommand(0, c.args);
+		case CMD_VSPLIT: return editorSplitCommand(1, c.args);
+		case CMD_CLOSE: return editorCloseWindow();
+		case CMD_DIFF: return editorDiffCommand();
+		case CMD_MARK: return editorSetMark(c.args);
+		case CMD_GOTO_MARK: return editorGotoMark(c.args);
+		case CMD_MARKS: editorListMarks(); break;
+		case CMD_TRIM: editorTransformCommand(c.start, c.end, TRANSFORM_TRIM); break;
+		case CMD_EXPAND: editorTransformCommand(c.start, c.end, TRANSFORM_EXPAND); break;
+		case CMD_UNEXPAND: editorTransformCommand(c.start, c.end, TRANSFORM_UNEXPAND); break;
+		case CMD_JOBS: editorListJobs(); break;
+		case CMD_CANCEL: return editorCancelJob();
+		case CMD_STATS: return editorStatsCommand();
+	}
+	return 0;
+}
+
+// func to complete the last part of a path to the longest prefix the files starting with it share, a directory that is the only match gets its slash, returns a new string or NULL if there is nothing to add
+char* editorCompletePath(const char* path){
+	const char* base = strrchr(path, '/');
+	base = base ? base + 1 : path;
+	int dirlen = base - path;
+	int baselen = strlen(base);
+
+	char* dir = dirlen ? strndup(path, dirlen) : strdup(".");
+	DIR* d = opendir(dir);
+	if(d == NULL){
+		free(dir);
+		return NULL;
+	}
+
+	// the longest prefix of the names that match
+	char* common = NULL;
+	int commonlen = 0, matches = 0;
+	struct dirent* e;
+	while((e = readdir(d)) != NULL){
+		if(strncmp(e->d_name, base, baselen) != 0) continue;
+		if(strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+		if(e->d_name[0] == '.' && base[0] != '.') continue;
+
+		if(matches++ == 0){
+			common = strdup(e->d_name);
+			commonlen = strlen(common);
+		} else {
+			int k = 0;
+			while(k < commonlen && common[k] == e->d_name[k]) k++;
+			commonlen = k;
+		}
+	}
+	closedir(d);
+
+	char* result = NULL;
+	if(matches && (commonlen > baselen || matches == 1)){
+		result = malloc(dirlen + commonlen + 2);
+		memcpy(result, path, dirlen);
+		memcpy(result + dirlen, common, commonlen);
+		result[dirlen + commonlen] = '\0';
+
+		struct stat st;
+		if(matches == 1 && stat(result, &st) == 0 && S_ISDIR(st.st_mode)) strcat(result, "/");
+		if(strcmp(result, path) == 0){
+			free(result);
+			result = NULL;
+		}
+	}
+	free(common);
+	free(dir);
+	return result;
+}
+
+// func to complete the command line typed so far, the name of the command and then the file name of the commands taking one, returns a new line or NULL if there is nothing to add
+char* editorCompleteCommand(const char* input){
+	char* line = strdup(input);
+	struct editorCommandLine c;
+	char* name;
+	int len = editorParseCommand(line, &c, &name);
+	char* result = NULL;
+
+	if(*c.rest == '\0' && len && isalpha((unsigned char)*name)){
+		// the longest prefix the names starting with what was typed share, one that is the only match gets a space for its arguments
+		const char* first = NULL;
+		int commonlen = 0, matches = 0;
+		for(int j = 0; j < YETI_COMMANDS; j++){
+			const char* n = editorCommands[j].name;
+			if(!isalpha((unsigned char)*n) || strncmp(n, name, len) != 0) continue;
+			if(matches++ == 0){
+				first = n;
+				commonlen = strlen(n);
+			} else {
+				int k = 0;
+				while(k < commonlen && first[k] == n[k]) k++;
+				commonlen = k;
+			}
+		}
+		if(matches && (commonlen > len || matches == 1)){
+			int prefix = name - line;
+			result = malloc(prefix + commonlen + 2);
+			memcpy(result, line, prefix);
+			memcpy(result + prefix, first, commonlen);
+			result[prefix + commonlen] = '\0';
+			if(matches == 1) strcat(result, " ");
+		}
+	} else if(c.args != c.rest){
+		const struct editorCommand* cmd = editorFindCommand(name, len);
+		char* path = cmd && cmd->file ? editorCompletePath(c.args) : NULL;
+		if(path){
+			int prefix = c.args - line;
+			result = malloc(prefix + strlen(path) + 1);
+			memcpy(result, line, prefix);
+			strcpy(result + prefix, path);
+			free(path);
+		}
+	}
+
+	free(line);
+	return result;
+}
+
+/***BATCH***/
+
+// func to run the commands of a batch script ("-" for stdin) one per line against the open file, returns the exit status
+int editorRunBatch(const char* script){
+	FILE* fp = strcmp(script, "-") == 0 ? stdin : fopen(script, "r");
+	if(!fp){
+		perror(script);
+		return 1;
+	}
+
+	char* line = NULL;
+	size_t linecap = 0;
+	ssize_t linelen;
+	int lineno = 0;
+	int status = 0;
+
+	while((linelen = getline(&line, &linecap, fp)) != -1){
+		lineno++;
+		while(linelen > 0 && (line[linelen-1] == '\n' || line[linelen-1] == '\r')) line[--linelen] = '\0';
+
+		// blank lines and comments are skipped
+		char* p = line;
+		while(isspace((unsigned char)*p)) p++;
+		if(*p == '\0' || *p == '#') continue;
+
+		// the script stops at the first failing command
+		if(editorRunCommand(p) == -1){
+			fprintf(stderr, "%s:%d: %s\n", script, lineno, state.statusmsg);
+			status = 1;
+			break;
+		}
+	}
+
+	free(line);
+	if(fp != stdin) fclose(fp);
+	return status;
+}
+
+/***APPEND BUFFER***/
+
+// struct to hold data about the buffer
+struct append_buffer{
+	char* b; // stores the text
+	int len; // stores the length of the string
+};
+
+#define APPENDBUF_INIT {NULL, 0} // macro constructor to initialize a new append buffer
+
+// func to append a new string to the buffer
+void appBuffAppend(struct append_buffer* ab, const char* s, int len){
+	// realloc more memory to the current string to be able to append the new string to it
+	char* new = (char*)realloc(ab->b, ab->len + len);
+	
+	// if the reallocation was not possible
+	if(new == NULL) return;
+
+	// copies the string to be appended to the newly allocated memory
+	memcpy(&new[ab->len], s, len);
+	
+	// update the current buffer with the newly appended pointer and len
+	ab->b = new;
+	ab->len += len;
+}
+
+// func to free the current buffer
+void appBuffFree(struct append_buffer* ab){
+	free(ab->b);
+}
+
+/***OUTPUT***/
+
+// func to write as much of the output waiting for a screen as its terminal takes without blocking, returns the no. of bytes still waiting
+int editorFlushOutput(windowList* l){
+	struct editorOutput* out = &l->out;
+	while(out->sent < out->len){
+		ssize_t n = write(l->outfd, out->b + out->sent, out->len - out->sent);
+		if(n == -1 && errno == EINTR) continue;
+		if(n == -1 && errno == EAGAIN) break;
+
+		// a terminal that went away takes nothing more, its hangup is noticed on the next read
+		if(n <= 0){
+			editorDropOutput(l);
+			return 0;
+		}
+		out->sent += n;
+	}
+
+	int left = out->len - out->sent;
+	if(left == 0) editorDropOutput(l);
+	return left;
+}
+
+// func to send bytes to the terminal of the screen in wl, they go behind whatever is still waiting and only what the terminal does not take now is copied
+void editorQueueOutput(const char* b, int len){
+	struct editorOutput* out = &wl.out;
+	if(out->len == 0){
+		ssize_t n;
+		while((n = write(wl.outfd, b, len)) == -1 && errno == EINTR);
+		if(n == -1 && errno != EAGAIN) return;
+		if(n > 0){
+			b += n;
+			len -= n;
+		}
+		if(len == 0) return;
+	}
+
+	out->b = realloc(out->b, out->len + len);
+	memcpy(out->b + out->len, b, len);
+	out->len += len;
+}
+
+// func to start a frame, a frame the terminal has not fully taken is stale by now so it is dropped and the new one redraws the whole screen
+void editorBeginFrame(struct append_buffer* ab){
+	if(wl.out.len == 0) return;
+
+	editorDropOutput(&wl);
+	editorFreeFrame(&wl);
+
+	// the dropped bytes may have stopped inside a scroll region or with colours on
+	appBuffAppend(ab, "\x1b[r\x1b[m", 6);
+}
+
+// handles scrolling of a window showing the given buffer
+void editorScroll(ewin* w, struct editorConfig* s){
+	// the text may have changed through another window
+	if(w->cy >= s->textrows) w->cy = s->textrows - 1;
+	if(w->cy < 0) w->cy = 0;
+	if(w->cx > s->row[w->cy].size + s->linenooff) w->cx = s->row[w->cy].size + s->linenooff;
+
+	// the height of the text area, the last row of the window is its status bar
+	int screenrows = w->rows - 1;
+
+	w->rx = s->linenooff;
+
+	// as long as the cursor is on a text line, call the convert function
+	if(w->cx > s->linenooff) w->rx += editorRowCxToRx(&s->row[w->cy], w->cx - s->linenooff);
+
+	// if the cursor is above the visible screen, the editor scrolls up to the cursor position
+	if(w->cy < w->rowoff) w->rowoff = w->cy;
+
+	// if the cursor is at the bottom of the screen, the editor is scrolled down depending on the difference between cy and screenrows and we add once since the y in editorDraw loop starts off with 0
+	if(w->cy >= w->rowoff + screenrows) w->rowoff = (w->cy - screenrows) + 1;
+
+	// same thing as above but for the horizontal scrolling
+	if(w->rx < w->coloff + s->linenooff) {
+		w->coloff = w->rx - s->linenooff;
+	}
+	if(w->rx >= w->coloff + w->cols) w->coloff = (w->rx - w->cols) + 1;
+}
+
+// func to fill the rest of a window line, a window touching the right edge just clears to the end of the line
+void editorPadLine(struct append_buffer* ab, ewin* w, int used){
+	if(w->left + w->cols >= wl.screencols){
+		appBuffAppend(ab, "\x1b[K", 3);
+		return;
+	}
+	while(used++ < w->cols) appBuffAppend(ab, " ", 1);
+}
+
+// func to draw one text row of a window, a dash for rows past the end of the text and the line no. and visible text for the others
+void editorDrawRows(struct append_buffer* ab, ewin* w, struct editorConfig* s, int y){
+	// the no. of columns used so far
+	int used;
+
+	// used to display the  correct range of lines based on the scroll position
+	int filerow = y + w->rowoff;
+
+	// if file row happens to be greater than the number of text lines present then we just print the dash to the editor
+	if(filerow >= s->textrows){
+		// writing the version of the editor one-third below the top only when there is no text present in the file supplied to the editor
+		if(s->row[0].size == 0 && y == (w->rows - 1) / 3){
+			// stores the text to be printed
+			char welcome[80];
+
+			// store a specific format of the text into the variable
+			int welcomelen = snprintf(welcome, sizeof(welcome), "Yeti ---> version %s", YETI_VERSION);
+			// reducing the text if the window has less width
+			if(welcomelen > w->cols) welcomelen = w->cols;
+
+			// centering the text
+			int padding = (w->cols - welcomelen) / 2;
+			used = padding + welcomelen;
+			if (padding){
+				appBuffAppend(ab, "-", 1);
+				padding--;
+			}
+			while(padding--)appBuffAppend(ab, " ", 1);
+
+			// write the text to the buffer
+			appBuffAppend(ab, welcome, welcomelen);
+		} else {
+			//append to the buffer the dashes to be drawn
+			appBuffAppend(ab, "-", 1);
+			used = 1;
+		}
+	} else {
+		// get the size of the text to be written to the editor
+		int len = s->row[filerow].rsize - w->coloff;
+
+		// if there is no text, then we do not write anything to the screen
+		if(len < 0) len = 0;
+
+		// buffer to print the line no
+		char lineno[80];
+
+		// holds th length of the current line no
+		int filerowLen = calculateDigits(filerow+1);
+
+		// holds the length of the max line no for the current file
+		int maxLen = calculateDigits(s->textrows);
+
+		// holds the diff in lengths
+		int diff = maxLen - filerowLen;
+
+		// save the width taken by the line no col to state
+		s->linenooff = maxLen + 1;
+
+		// if the size of the text is bigger than that of the window, we  only show the  text that can be accomodated
+		if(len + s->linenooff > w->cols) len = w->cols - s->linenooff;
+		if(len < 0) len = 0;
+
+		// the line no is padded on the left so the line nos line up properly
+		int linelen = snprintf(lineno, sizeof(lineno), "%*s\033[1;36m%d\033[0m ", diff, "", filerow+1);
+
+		// appending the line no to be printed
+		appBuffAppend(ab, lineno, linelen);
+
+		// appending the text to the append buffer that is used to write to the screen
+		if(len) appBuffAppend(ab, &s->row[filerow].render[w->coloff], len);
+		used = s->linenooff + len;
+	}
+
+	// clear the rest of the line once the text is drawn
+	editorPadLine(ab, w, used);
+}
+
+// func to draw the status bar of a window
+void editorDrawStatusBar(struct append_buffer* ab, ewin* w, struct editorConfig* s){
+	// this tells the terminal to invert the colors attribute to the text written after this call
+	appBuffAppend(ab, "\x1b[7m",  4);
+
+	// state buffer to store the filename if it exists and rstatus to show the current cursor line and the modifed buffer to show the  number of lines modified
+	char modified[30], status[80], rstatus[80];
+
+	snprintf(modified, sizeof(modified), "(%d modifications)", s->edits);
+
+	// the buffer no. is only shown once there is more than one
+	char bufno[32] = "";
+	if(bl.size > 1) snprintf(bufno, sizeof(bufno), "[%d/%d] ", w->buf + 1, bl.size);
+
+	// the jobs running on the buffer show how far they got
+	char progress[48];
+	editorJobStatus(w->buf, progress, sizeof(progress));
+
+	int len = snprintf(status, sizeof(status), "%s%.20s - %d lines %s%s", bufno, s->filename ? s->filename : "[No Name]", s->textrows, s->modified ? modified : "", progress);
+	int rlen = snprintf(rstatus, sizeof(rstatus), "%d/%d", w->cx - s->linenooff + 1 > 0 ? w->cx - s->linenooff + 1 : 1, s->row[w->cy].size);
+	if(len > w->cols) len = w->cols;
+	appBuffAppend(ab, status, len);
+
+	// write spaces so the entire status bar turns white
+	while(len < w->cols){
+		// write the current cursor line to the end of the status bar
+		if(w->cols - len == rlen){
+			appBuffAppend(ab, rstatus, rlen);
+			break;
+		} else {
+			appBuffAppend(ab, " ", 1);
+			len++;
+		}
+	}
+	appBuffAppend(ab, "\x1b[m", 3);
+}
+
+// writes the status message to the append buffer which lateer writes it to the screen
+void editorDrawMessageBar(struct append_buffer* ab){
+	// clears the previous status message
+	appBuffAppend(ab, "\x1b[K", 3);
+
+	// store the length of the status message
+	int msglen = strlen(state.statusmsg);
+
+	// adjust the length of the status message incase it is bigger than the editor
+	if(msglen > wl.screencols) msglen = wl.screencols;
+
+	// we write the status message to the screen only if it has some text, its timer clears it once it is old
+	if(msglen) appBuffAppend(ab, state.statusmsg, msglen);
+}
+
+
+// func to add a screen line to the frame only if it differs from what was last drawn there
+void editorFlushLine(struct append_buffer* frame, char** cached, int* cachedlen, int row, int col, struct append_buffer* line){
+	if(*cached && *cachedlen == line->len && memcmp(*cached, line->b, line->len) == 0) return;
+
+	// move to the start of the line and draw it
+	char buffer[32];
+	int len = snprintf(buffer, sizeof(buffer), "\x1b[%d;%dH", row + 1, col + 1);
+	appBuffAppend(frame, buffer, len);
+	appBuffAppend(frame, line->b, line->len);
+
+	// remember what is on the screen now
+	*cached = realloc(*cached, line->len ? line->len : 1);
+	memcpy(*cached, line->b, line->len);
+	*cachedlen = line->len;
+}
+
+// func to let the terminal scroll the text of a full width window whose view moved by less than its height, the drawn lines are moved along so only the ones that came into view are drawn again
+void editorScrollFrame(struct append_buffer* frame, ewin* w){
+	int shift = w->rowoff - w->drawnrowoff;
+	int textrows = w->rows - 1;
+	w->drawnrowoff = w->rowoff;
+
+	// the scroll region can only be set on whole lines of the screen
+	if(shift == 0 || abs(shift) >= textrows || w->left != 0 || w->cols != wl.screencols) return;
+
+	char buffer[48];
+	int len = snprintf(buffer, sizeof(buffer), "\x1b[%d;%dr\x1b[%d%c\x1b[r", w->top + 1, w->top + textrows, abs(shift), shift > 0 ? 'S' : 'T');
+	appBuffAppend(frame, buffer, len);
+
+	// the lines scrolled off are forgotten and the ones scrolled in are blank until they are drawn
+	int d = abs(shift);
+	int gone = shift > 0 ? 0 : textrows - d;
+	for(int y = gone; y < gone + d; y++) free(w->lines[y]);
+	if(shift > 0){
+		memmove(&w->lines[0], &w->lines[d], sizeof(char*) * (textrows - d));
+		memmove(&w->lens[0], &w->lens[d], sizeof(int) * (textrows - d));
+		for(int y = textrows - d; y < textrows; y++) w->lines[y] = NULL;
+	} else {
+		memmove(&w->lines[d], &w->lines[0], sizeof(char*) * (textrows - d));
+		memmove(&w->lens[d], &w->lens[0], sizeof(int) * (textrows - d));
+		for(int y = 0; y < d; y++) w->lines[y] = NULL;
+	}
+}
+
+// func to redraw just the message bar, used when a timer changed it while no key was pressed, the cursor is put back where it was
+void editorRefreshMessageBar(){
+	struct append_buffer ab = APPENDBUF_INIT;
+	struct append_buffer msg = APPENDBUF_INIT;
+	editorDrawMessageBar(&msg);
+	editorFlushLine(&ab, &wl.msgline, &wl.msglen, wl.screenrows - 1, 0, &msg);
+	appBuffFree(&msg);
+	if(ab.len == 0) return;
+
+	struct append_buffer frame = APPENDBUF_INIT;
+	appBuffAppend(&frame, "\x1b[?25l\x1b" "7", 8);
+	appBuffAppend(&frame, ab.b, ab.len);
+	appBuffAppend(&frame, "\x1b" "8\x1b[?25h", 8);
+	editorQueueOutput(frame.b, frame.len);
+	appBuffFree(&frame);
+	appBuffFree(&ab);
+}
+
+// func to draw the lines of a window that changed since the last refresh
+void editorDrawWindow(struct append_buffer* frame, int n){
+	ewin* w = &wl.wins[n];
+	struct editorConfig* s = editorBufferState(w->buf);
+	editorScroll(w, s);
+
+	// each window keeps its own slice of what is on the screen
+	if(w->lines == NULL){
+		w->lines = calloc(w->rows, sizeof(char*));
+		w->lens = calloc(w->rows, sizeof(int));
+		w->drawnrowoff = w->rowoff;
+	}
+	editorScrollFrame(frame, w);
+
+	struct append_buffer line = APPENDBUF_INIT;
+	for(int y = 0; y < w->rows; y++){
+		line.len = 0;
+
+		// the last row of the window is its status bar
+		if(y < w->rows - 1) editorDrawRows(&line, w, s, y);
+		else editorDrawStatusBar(&line, w, s);
+
+		// windows that do not touch the right edge are followed by a separator
+		if(w->left + w->cols < wl.screencols) appBuffAppend(&line, "|", 1);
+
+		editorFlushLine(frame, &w->lines[y], &w->lens[y], w->top + y, w->left, &line);
+	}
+	appBuffFree(&line);
+}
+
+// func to clear the screen
+void editorRefreshScreen(){
+	// the pager draws straight from its mapping
+	if(pagermode){
+		editorPagerRefresh();
+		return;
+	}
+
+	// the active window gets the cursor and view of the buffer being edited
+	editorSaveWindow();
+
+	// initialize an empty append buffer
+	struct append_buffer ab = APPENDBUF_INIT;
+	editorBeginFrame(&ab);
+
+	// hide cursor while re drawing to the screen
+	appBuffAppend(&ab, "\x1b[?25l", 6);
+
+	// call func to write the lines of every window that changed
+	for(int j = 0; j < wl.size; j++) editorDrawWindow(&ab, j);
+
+	// call func to write the status message
+	struct append_buffer msg = APPENDBUF_INIT;
+	editorDrawMessageBar(&msg);
+	editorFlushLine(&ab, &wl.msgline, &wl.msglen, wl.screenrows - 1, 0, &msg);
+	appBuffFree(&msg);
+
+	// scrolling may have moved the view of the active window
+	ewin* w = &wl.wins[wl.curr];
+	state.cx = w->cx;
+	state.cy = w->cy;
+	state.rx = w->rx;
+	state.rowoff = w->rowoff;
+	state.coloff = w->coloff;
+
+	// buffer to store the position of the cursor in a specific format
+	char buffer[32];
+
+	if(state.cx < state.linenooff && state.rx < state.linenooff){
+		state.cx = state.linenooff;
+		state.rx = state.linenooff;
+	}
+
+	// store the position of the cursor in the required format
+	snprintf(buffer, sizeof(buffer), "\x1b[%d;%dH", w->top + (state.cy - state.rowoff) + 1, w->left + (state.rx - state.coloff) + 1);
+
+	// store the position to in the buffer
+	appBuffAppend(&ab, buffer, strlen(buffer));
+
+	// show the cursor
+	appBuffAppend(&ab, "\x1b[?25h", 6);
+
+	// now do one big write to the screen with the help of the buffer, whatever the terminal does not take is queued
+	editorQueueOutput(ab.b, ab.len);
+
+	// free the buffer
+	appBuffFree(&ab);
+}
+
+// func to set the status message
+void editorSetStatusMessage(const char *fmt, ...){
+	va_list ap;
+	va_start(ap, fmt);
+	vsnprintf(state.statusmsg, sizeof(state.statusmsg), fmt, ap);
+	va_end(ap);
+	editorTimerStart(TIMER_MESSAGE, YETI_MESSAGE_MS);
+}
+
+/***INPUT***/
+
+// func to get the filename to save if he opens a blank editor
+char* editorPrompt(char* prompt, struct editorHistory* hist, void (*callback)(char*, int), char* (*complete)(const char*)){
+	// initial buffeer size for the user input
+	size_t bufsize = 128;
+
+	// allocate a buffer to store user input
+	char* buf = malloc(bufsize);
+	size_t buflen = 0;
+	buf[0] = '\0';
+
+	// the history entry being shown, the size of the history means the input being typed which is kept aside while browsing
+	int histpos = hist ? hist->size : 0;
+	char* draft = NULL;
+	prompting++;
+
+	// loop till the user presses enter
+	while(1){
+		// renders the input typed by the user
+		editorSetStatusMessage(prompt, buf);
+
+		// the prompt stays until it is answered
+		editorTimerStop(TIMER_MESSAGE);
+
+		// the text only changes under a prompt with a callback (like the search moving the cursor), otherwise just the message bar is redrawn
+		if(callback) editorRefreshScreen();
+		else editorRefreshMessageBar();
+
+		// reads each key pressed by the user
+		int c = editorReadKey();
+		
+		// if the user presses backspace we delete the previous char
+		if(c == DEL_KEY || c == CTRL_KEY('h') || c == BACKSPACE){
+			if(buflen != 0) buf[--buflen] = '\0';
 
 		// if the user pressed escape we exit the prompt
 		} else if(c == '\x1b'){
 			editorSetStatusMessage("");
 			if(callback) callback(buf, c);
 			free(buf);
+			free(draft);
+			prompting--;
 			return NULL;
 
-		// if the user presses enter we return the input
-		} else if(c == '\r'){
-			if(buflen != 0){
-				editorSetStatusMessage("");
-				if(callback) callback(buf, c);
-				return buf;
-			}
+		// if the user presses enter we return the input
+		} else if(c == '\r'){
+			if(buflen != 0){
+				editorSetStatusMessage("");
+				if(callback) callback(buf, c);
+				if(hist) editorHistoryAdd(hist, buf);
+				free(draft);
+				prompting--;
+				return buf;
+			}
+
+		// tab completes what was typed so far
+		} else if(c == '\t' && complete){
+			char* completed = complete(buf);
+			if(completed){
+				free(buf);
+				buf = completed;
+				buflen = strlen(buf);
+				bufsize = buflen + 1;
+			}
+
+		// ctrl-p and ctrl-n step through the history
+		} else if(hist && ((c == CTRL_KEY('p') && histpos > 0) || (c == CTRL_KEY('n') && histpos < hist->size))){
+			if(histpos == hist->size) draft = strdup(buf);
+			histpos += c == CTRL_KEY('p') ? -1 : 1;
+
+			const char* shown = histpos < hist->size ? hist->items[histpos] : draft;
+			buflen = strlen(shown);
+			if(buflen >= bufsize){
+				bufsize = buflen + 1;
+				buf = realloc(buf, bufsize);
+			}
+			memcpy(buf, shown, buflen + 1);
+			if(histpos == hist->size){
+				free(draft);
+				draft = NULL;
+			}
+
+		// in case the buffer size is less, we double it
+		} else if(!iscntrl(c) && c < 128){
+			if(buflen == bufsize - 1){
+				bufsize *= 2;
+				buf = realloc(buf, bufsize);
+			}
+			buf[buflen++] = c;
+			buf[buflen] = '\0';
+		}
+
+		if(callback) callback(buf, c);
+	}
+}
+
+//handles movement of cursor in the editor, n times in one go for a held down key
+void editorMoveCursor(int key, int n){
+	// the height of the text area, a page moves by that much
+	int page = state.screenrows > 1 ? state.screenrows : 1;
+
+	// switch case to change the global state of the cursor
+	switch(key){
+		// horizontal moves wrap to the neighbouring line at either end of a line, each line is crossed in one step
+		case ARROW_LEFT:
+			while(n > 0){
+				int left = state.cx - state.linenooff;
+				if(n <= left){
+					state.cx -= n;
+					break;
+				}
+				if(state.cy == 0){
+					state.cx = state.linenooff;
+					break;
+				}
+				n -= left + 1;
+				state.cy--;
+				state.cx = state.row[state.cy].size + state.linenooff; 
+			}
+			break;
+		case ARROW_RIGHT:
+			while(n > 0 && state.cy < state.textrows){
+				int right = state.row[state.cy].size + state.linenooff - state.cx;
+				if(n <= right){
+					state.cx += n;
+					break;
+				}
+				if(state.cy == state.textrows - 1){
+					state.cx += right;
+					break;
+				}
+				n -= right + 1;
+				state.cy++;
+				state.cx = state.linenooff;
+			}
+			break;
+
+		// vertical moves are a single step however far they go
+		case ARROW_UP:
+			state.cy = state.cy > n ? state.cy - n : 0;
+			break;
+		case ARROW_DOWN:
+			state.cy = state.cy + n < state.textrows ? state.cy + n : state.textrows - 1;
+			break;
+
+		// a page move scrolls the view along with the cursor so the cursor stays on the same screen line
+		case PAGE_UP:
+			state.cy = state.cy > n * page ? state.cy - n * page : 0;
+			state.rowoff = state.rowoff > n * page ? state.rowoff - n * page : 0;
+			break;
+		case PAGE_DOWN:
+			state.cy = state.cy + n * page < state.textrows ? state.cy + n * page : state.textrows - 1;
+			state.rowoff = state.rowoff + n * page < state.textrows ? state.rowoff + n * page : state.textrows - 1;
+			break;
+
+		case HOME_KEY:
+			state.cx = state.linenooff;
+			break;
+		case END_KEY:
+			if(state.cy < state.textrows) state.cx = state.row[state.cy].size + state.linenooff;
+			break;
+	}
+	
+	erow* row = state.cy < state.textrows ? &state.row[state.cy] : NULL;
+	if(row && state.cx > row->size + state.linenooff) state.cx = row->size + state.linenooff;
+
+}
+
+// func to find the window at a screen position, returns -1 for the message bar
+int editorWindowAt(int x, int y){
+	for(int j = 0; j < wl.size; j++){
+		ewin* w = &wl.wins[j];
+		if(y >= w->top && y < w->top + w->rows && x >= w->left && x <= w->left + w->cols) return j;
+	}
+	return -1;
+}
+
+// func to scroll window n by the given no. of lines, its cursor is kept inside the view so drawing does not scroll it back
+void editorScrollWindow(int n, int lines){
+	editorSaveWindow();
+	ewin* w = &wl.wins[n];
+	struct editorConfig* s = editorBufferState(w->buf);
+	int textrows = w->rows - 1;
+
+	w->rowoff += lines;
+	if(w->rowoff > s->textrows - 1) w->rowoff = s->textrows - 1;
+	if(w->rowoff < 0) w->rowoff = 0;
+	if(w->cy < w->rowoff) w->cy = w->rowoff;
+	if(w->cy >= w->rowoff + textrows) w->cy = w->rowoff + textrows - 1;
+	if(w->cy >= s->textrows) w->cy = s->textrows - 1;
+
+	if(n == wl.curr) editorLoadWindow();
+}
+
+// func to put the cursor where the mouse was clicked, making the window clicked in the active one
+void editorClickAt(int x, int y){
+	int n = editorWindowAt(x, y);
+	if(n == -1) return;
+	if(n != wl.curr){
+		editorSaveWindow();
+		wl.curr = n;
+		editorLoadWindow();
+	}
+
+	// a click on the status bar only activates the window
+	ewin* w = &wl.wins[n];
+	if(y == w->top + w->rows - 1) return;
+
+	state.cy = state.rowoff + (y - w->top);
+	if(state.cy >= state.textrows) state.cy = state.textrows - 1;
+	erow* row = &state.row[state.cy];
+
+	// the column in the render is only mapped back through the tabs when the row has any
+	int rx = x - w->left - state.linenooff + state.coloff;
+	if(rx < 0) rx = 0;
+	int cx = row->rsize == row->size ? (rx < row->size ? rx : row->size) : editorRowRxToCx(row, rx);
+	state.cx = state.linenooff + cx;
+}
+
+// func to handle the mouse event in mouse and the ones read along with it, the wheel steps are added up into one scroll and only the last click or drag counts
+void editorMouseEvent(){
+	int scroll = 0, clicked = 0, wheelx = 0, wheely = 0;
+	struct editorMouse click = mouse;
+	int len;
+	while(1){
+		if(mouse.button & 64){
+			scroll += (mouse.button & 1) ? YETI_WHEEL_LINES : -YETI_WHEEL_LINES;
+			wheelx = mouse.x;
+			wheely = mouse.y;
+		} else if(mouse.pressed && (mouse.button & 3) == 0){
+			// a press or a drag of the left button
+			click = mouse;
+			clicked = 1;
+		}
+		if(editorScanKey(&wl.in, 0, &len) != MOUSE_EVENT) break;
+		editorInputConsume(&wl.in, len);
+	}
+
+	if(clicked) editorClickAt(click.x, click.y);
+	if(scroll){
+		int n = editorWindowAt(wheelx, wheely);
+		if(n != -1) editorScrollWindow(n, scroll);
+	}
+}
+
+// func to process keypress
+void editorProcessKeypress(){
+	int c = editorReadKey();
+
+	switch (c){
+		// search
+		case CTRL_KEY('f'):
+			editorFind();
+			break;
+
+		// enter key
+		case '\r':
+			editorInsertNewLine();
+			break;
+
+		// process commands after hitting the esc, semicolon is used as in c it shows a warning if you declare a variable right after the label 
+		case '\x1b': ;
+			// stores the command typed by the user
+			char* command = editorPrompt("COMMAND: %s (ESC = cancel | Tab = complete | q = force quit | u = undo)", &cmdhist, NULL, editorCompleteCommand);
+			
+			// if the user types a command
+			if(command){
+				editorRunCommand(command);
+				free(command);
+			}
+			break;
+		
+		// quit when changes are saved
+		case CTRL_KEY('q'):
+			if(state.modified){
+				editorSetStatusMessage("Unsaved file changes! Save and quit or use ESC + q to force quit.");
+				return;
+			}
+			if(editorModifiedBuffer() != -1){
+				editorSetStatusMessage("Unsaved file changes in buffer %d! Save it or use ESC + q to force quit.", editorModifiedBuffer() + 1);
+				return;
+			}
+			editorQuit();
+			break;
+		
+		// saves changes to the disk
+		case CTRL_KEY('s'):
+			editorSave();
+			break;
+		
+		// delete a character
+		case BACKSPACE:
+		case CTRL_KEY('h'):
+			editorDelChar();
+			break;
+		case DEL_KEY:
+			editorMoveCursor(ARROW_RIGHT, 1);
+			editorDelChar();
+			break;
+
+		// moves the cursor, the repeats of a held down key already read are folded into one move so only one frame is drawn for them
+		case ARROW_UP:
+		case ARROW_DOWN:
+		case ARROW_LEFT:
+		case ARROW_RIGHT:
+		case PAGE_UP:
+		case PAGE_DOWN:
+		case HOME_KEY:
+		case END_KEY:
+			editorMoveCursor(c, 1 + editorSkipRepeats(c));
+			break;
+		
+		// redraws the whole screen
+		case CTRL_KEY('l'):
+			editorInvalidateFrame();
+			break;
+
+		// moves to the next window
+		case CTRL_KEY('w'):
+			editorNextWindow();
+			break;
+
+		case MOUSE_EVENT:
+			editorMouseEvent();
+			break;
+
+		// goes back and forth through the positions jumped from
+		case CTRL_KEY('o'):
+			editorJumpBack();
+			break;
+		case CTRL_KEY('n'):
+			editorJumpForward();
+			break;
+
+		// a long edit gets its next slice between keys and escape cancels it
+		case WORK_EVENT:
+			editorRunWork();
+			break;
+		case WORK_CANCEL:
+			editorCancelWork();
+			break;
+
+		// the output of a job or task that is done is used, ctrl-c cancels the newest job on the buffer
+		case JOB_EVENT:
+			editorFinishJobs();
+			editorPoolComplete();
+			break;
+		case CTRL_KEY('c'):
+			editorCancelJob();
+			break;
+
+		// add characters, the special keys that are not bound to anything are ignored
+		default:
+			if(c < ARROW_LEFT) editorInsertChar(c);
+			break;
+	}
+}
+
+/***SERVER***/
+
+// func to make client n the one whose keys are processed, its windows are moved into wl and the ones of the previous client are stored with it
+void editorSelectClient(int n){
+	if(n == cl.curr) return;
+	if(cl.curr != -1){
+		editorSaveWindow();
+		cl.clients[cl.curr].wl = wl;
+	}
+	cl.curr = n;
+	wl = cl.clients[n].wl;
+	editorLoadWindow();
+}
+
+// func to forget a client and free its screen
+void editorDropClient(int n){
+	editorSelectClient(n);
+	close(wl.infd);
+	editorFreeFrame(&wl);
+	editorDropOutput(&wl);
+	free(wl.wins);
+	wl.wins = NULL;
+	wl.size = 0;
+
+	memmove(&cl.clients[n], &cl.clients[n + 1], sizeof(eclient) * (cl.size - n - 1));
+	cl.size--;
+	cl.curr = -1;
+}
+
+// func to read the hello line a client starts with, "YETI 1 rows cols path", the path may be empty, returns -1 if it is malformed
+int editorReadHello(int fd, int* rows, int* cols, char* path, int pathlen){
+	char line[4096 + 64];
+	int len = 0;
+
+	// a client that never says hello must not stall the server
+	struct timeval tv = {1, 0};
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	while(len < (int)sizeof(line) - 1){
+		if(read(fd, &line[len], 1) != 1) return -1;
+		if(line[len] == '\n') break;
+		len++;
+	}
+	line[len] = '\0';
+	tv.tv_sec = 0;
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+	int start = 0;
+	if(sscanf(line, "YETI 1 %d %d %n", rows, cols, &start) != 2 || start == 0) return -1;
+	if(*rows < 6 || *cols < 20 || (int)strlen(&line[start]) >= pathlen) return -1;
+	strcpy(path, &line[start]);
+	return 0;
+}
+
+// func to set up a newly connected client with a window of its own, showing the file it asked for or the buffer being edited
+void editorAcceptClient(int listener){
+	int fd = accept(listener, NULL, NULL);
+	if(fd == -1) return;
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	int rows, cols;
+	char path[4096];
+	if(editorReadHello(fd, &rows, &cols, path, sizeof(path)) == -1){
+		close(fd);
+		return;
+	}
+
+	// the windows of the previous client are stored with it, the ones set up by initEditor are not needed once a client exists
+	if(cl.curr != -1){
+		editorSaveWindow();
+		cl.clients[cl.curr].wl = wl;
+	} else {
+		editorFreeFrame(&wl);
+		free(wl.wins);
+	}
+
+	editorInitWindows(rows, cols, fd, fd);
+
+	// a client that stops reading must not stall the others
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	cl.clients = realloc(cl.clients, sizeof(eclient) * (cl.size + 1));
+	cl.clients[cl.size].gone = 0;
+	cl.curr = cl.size++;
+
+	// a file already open in another buffer is just switched to
+	if(*path) editorOpen(path);
+}
+
+// func to run the editor as a server, every client gets its own windows onto the same buffers so edits show up on all of them, returns once the last client left with nothing unsaved
+int editorRunServer(const char* sockpath){
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(strlen(sockpath) >= sizeof(addr.sun_path)){
+		fprintf(stderr, "%s: socket path too long\n", sockpath);
+		return 1;
+	}
+	strcpy(addr.sun_path, sockpath);
+
+	int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(listener == -1) die("socket");
+	unlink(sockpath);
+	if(bind(listener, (struct sockaddr*)&addr, sizeof(addr)) == -1) die("bind");
+	if(listen(listener, 8) == -1) die("listen");
+
+	// a client hanging up while a frame is written to it is noticed on its next read
+	signal(SIGPIPE, SIG_IGN);
+
+	struct pollfd* fds = NULL;
+	int served = 0;
+	while(1){
+		// the listener comes first and the clients follow in order
+		fds = realloc(fds, sizeof(struct pollfd) * (cl.size + 2 + 2 * YETI_JOBS_MAX));
+		fds[0].fd = listener;
+		fds[0].events = POLLIN;
+		for(int j = 0; j < cl.size; j++){
+			fds[j + 1].fd = cl.clients[j].wl.infd;
+			if(j == cl.curr) fds[j + 1].fd = wl.infd;
+			fds[j + 1].events = POLLIN;
+
+			// a client that did not take all of its frames is written to once it can take more
+			windowList* l = j == cl.curr ? &wl : &cl.clients[j].wl;
+			if(l->out.len) fds[j + 1].events |= POLLOUT;
+		}
+		int njobs = editorJobsPollFds(&fds[cl.size + 1]);
+		njobs += editorPoolPollFd(&fds[cl.size + 1 + njobs]);
+		// the server also wakes up for the next timer
+		if(poll(fds, cl.size + 1 + njobs, editorTimerTimeout()) == -1){
+			if(errno == EINTR) continue;
+			die("poll");
+		}
+
+		int changed = editorRunJobs();
+		int expired = editorRunTimers();
+
+		for(int j = 0; j < cl.size; j++){
+			if(fds[j + 1].revents & POLLOUT) editorFlushOutput(j == cl.curr ? &wl : &cl.clients[j].wl);
+		}
+
+		// handle the keys of every client that sent some, in order
+		int nclients = cl.size;
+		for(int j = nclients - 1; j >= 0; j--){
+			if(!(fds[j + 1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+			char c;
+			if(recv(fds[j + 1].fd, &c, 1, MSG_PEEK) <= 0) cl.clients[j].gone = 1;
+			else {
+				// every key the client sent is handled, the ones read along with the first are already buffered so poll would not report them
+				editorSelectClient(j);
+				do editorProcessKeypress();
+				while(!cl.clients[j].gone && editorKeyPending());
+			}
+			changed = 1;
+		}
+
+		// clients that quit or hung up are forgotten
+		for(int j = cl.size - 1; j >= 0; j--){
+			if(cl.clients[j].gone) editorDropClient(j);
+		}
+
+		// the output of the jobs and tasks that are done is used on behalf of the client that was active last
+		if(cl.size && (editorJobsDone() || editorPoolDone())){
+			editorSelectClient(cl.curr == -1 ? 0 : cl.curr);
+			editorFinishJobs();
+			editorPoolComplete();
+			changed = 1;
+		}
+
+		if(fds[0].revents & POLLIN){
+			editorAcceptClient(listener);
+			served = 1;
+			changed = 1;
+		}
+
+		// the server stays up while it is holding unsaved changes so a client can come back for them
+		if(served && cl.size == 0 && editorModifiedBuffer() == -1) break;
+
+		// a timer that fired on its own only changed the message bar
+		if(!changed && expired){
+			for(int j = 0; j < cl.size; j++){
+				editorSelectClient(j);
+				editorRefreshMessageBar();
+			}
+		}
+		if(!changed) continue;
+
+		// every client sees what the others did
+		for(int j = 0; j < cl.size; j++){
+			editorSelectClient(j);
+			editorRefreshScreen();
+		}
+	}
+
+	free(fds);
+	close(listener);
+	unlink(sockpath);
+	return 0;
+}
+
+// func to run the editor as a client of a server, the terminal is relayed to the server which does all the editing
+int editorRunClient(const char* sockpath, const char* filename){
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(strlen(sockpath) >= sizeof(addr.sun_path)){
+		fprintf(stderr, "%s: socket path too long\n", sockpath);
+		return 1;
+	}
+	strcpy(addr.sun_path, sockpath);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd == -1 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1){
+		perror(sockpath);
+		return 1;
+	}
+
+	enableRawMode();
+	int rows, cols;
+	if(getWindowSize(&rows, &cols) == -1) die("getWindowSize");
+
+	// the server has its own working directory so a relative path is made absolute
+	char cwd[2048], hello[4096 + 64];
+	int len;
+	if(filename == NULL) len = snprintf(hello, sizeof(hello), "YETI 1 %d %d \n", rows, cols);
+	else if(filename[0] == '/' || getcwd(cwd, sizeof(cwd)) == NULL) len = snprintf(hello, sizeof(hello), "YETI 1 %d %d %s\n", rows, cols, filename);
+	else len = snprintf(hello, sizeof(hello), "YETI 1 %d %d %s/%s\n", rows, cols, cwd, filename);
+	if(len >= (int)sizeof(hello) || write(fd, hello, len) != len) die("hello");
+
+	// relay keys to the server and frames back until the server hangs up
+	struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {fd, POLLIN, 0}};
+	char buffer[4096];
+	while(1){
+		if(poll(fds, 2, -1) == -1){
+			if(errno == EINTR) continue;
+			die("poll");
+		}
+		if(fds[0].revents & POLLIN){
+			ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+			if(n > 0 && write(fd, buffer, n) != n) break;
+		}
+		if(fds[1].revents & (POLLIN | POLLHUP | POLLERR)){
+			ssize_t n = read(fd, buffer, sizeof(buffer));
+			if(n <= 0) break;
+			if(write(STDOUT_FILENO, buffer, n) != n) break;
+		}
+	}
+
+	close(fd);
+	write(STDOUT_FILENO, "\x1b[2J", 4);
+	write(STDOUT_FILENO, "\x1b[H", 3);
+	return 0;
+}
+
+/***PAGER***/
+
+// func to get the offset of the newline ending the line at off, or the size of the file for the last line
+size_t editorPagerLineEnd(size_t off){
+	const char* nl = memchr(pager.map + off, '\n', pager.size - off);
+	return nl ? (size_t)(nl - pager.map) : pager.size;
+}
+
+// func to get the offset of the start of the line holding off
+size_t editorPagerLineStart(size_t off){
+	if(off == 0) return 0;
+	const char* nl = memrchr(pager.map, '\n', off);
+	return nl ? (size_t)(nl - pager.map) + 1 : 0;
+}
+
+// func to move the top of the view n lines down, the last line of the file is the lowest it goes
+void editorPagerDown(int n){
+	while(n-- > 0){
+		size_t end = editorPagerLineEnd(pager.top);
+		if(end + 1 >= pager.size) break;
+		pager.top = end + 1;
+	}
+}
+
+// func to move the top of the view n lines up
+void editorPagerUp(int n){
+	while(n-- > 0 && pager.top > 0) pager.top = editorPagerLineStart(pager.top - 1);
+}
+
+// func to move the view so its last screenful of lines ends with the file
+void editorPagerEnd(){
+	size_t off = pager.size;
+	if(off > 0 && pager.map[off - 1] == '\n') off--;
+	pager.top = editorPagerLineStart(off);
+	editorPagerUp(state.screenrows - 1);
+}
+
+// func to keep the cursor of the hex view on the screen
+void editorHexScroll(){
+	size_t rows = state.screenrows > 0 ? state.screenrows : 1;
+	size_t line = pager.cursor / YETI_HEX_WIDTH;
+	if(line < pager.top / YETI_HEX_WIDTH) pager.top = line * YETI_HEX_WIDTH;
+	if(line >= pager.top / YETI_HEX_WIDTH + rows) pager.top = (line - rows + 1) * YETI_HEX_WIDTH;
+}
+
+// func to put the cursor of the hex view on a byte
+void editorHexMoveTo(size_t off){
+	pager.cursor = off < pager.size ? off : (pager.size ? pager.size - 1 : 0);
+	pager.nibble = 0;
+	editorHexScroll();
+}
+
+// func to show the line holding a match at the top of the view with the match scrolled into view, the hex view puts its cursor on it
+void editorPagerShowMatch(size_t match){
+	pager.match = match;
+	if(pager.hex){
+		editorHexMoveTo(match);
+		return;
+	}
+	pager.top = editorPagerLineStart(match);
+
+	// the column of the match counts the tabs before it
+	int col = 0;
+	for(size_t j = pager.top; j < match; j++) col = pager.map[j] == '\t' ? (col / YETI_TAB_STOP + 1) * YETI_TAB_STOP : col + 1;
+	if(col < pager.coloff || col >= pager.coloff + state.screencols) pager.coloff = col > state.screencols / 2 ? col - state.screencols / 2 : 0;
+}
+
+// func to search for the query forwards (direction 1) or backwards (direction -1) from the last match or the top of the view
+void editorPagerSearch(int direction){
+	if(pager.query == NULL){
+		editorSetStatusMessage("No previous search");
+		return;
+	}
+	size_t qlen = pager.qlen;
+
+	const char* found;
+	if(direction == 1){
+		size_t from = pager.match != (size_t)-1 ? pager.match + 1 : (pager.hex ? pager.cursor : pager.top);
+		found = from <= pager.size ? editorMemSearch(pager.map + from, pager.size - from, pager.query, qlen) : NULL;
+	} else {
+		size_t before = pager.match != (size_t)-1 ? pager.match : (pager.hex ? pager.cursor : pager.top);
+		found = editorMemSearchBack(pager.map, before + qlen - 1 < pager.size ? before + qlen - 1 : pager.size, pager.query, qlen);
+	}
 
-		// in case the buffer size is less, we double it
-		} else if(!iscntrl(c) && c < 128){
-			if(buflen == bufsize - 1){
-				bufsize *= 2;
-				buf = realloc(buf, bufsize);
-			}
-			buf[buflen++] = c;
-			buf[buflen] = '\0';
+	if(found == NULL){
+		if(pager.hex) editorSetStatusMessage("Pattern not found");
+		else editorSetStatusMessage("Pattern not found: %s", pager.query);
+		return;
+	}
+	editorPagerShowMatch(found - pager.map);
+}
+
+// func to ask for an offset, or a percentage of the file when followed by %, and show the line holding it
+void editorPagerGoto(){
+	char* input = editorPrompt("Goto offset (or N%%): %s", NULL, NULL, NULL);
+	if(input == NULL) return;
+
+	char* end;
+	unsigned long long off = strtoull(input, &end, 10);
+	if(*end == '%') off = off >= 100 ? pager.size : pager.size / 100 * off + pager.size % 100 * off / 100;
+	else if(*end != '\0'){
+		editorSetStatusMessage("Not an offset: %s", input);
+		free(input);
+		return;
+	}
+	free(input);
+
+	if(off > pager.size) off = pager.size;
+	pager.match = (size_t)-1;
+	if(pager.hex) editorHexMoveTo(off);
+	else pager.top = editorPagerLineStart(off);
+}
+
+// func to turn a typed hex pattern like "de ad be ef" into bytes in place, returns the no. of bytes or -1 if it is not hex
+int editorHexParse(char* input){
+	int len = 0, high = -1;
+	for(char* p = input; *p; p++){
+		if(isspace((unsigned char)*p)) continue;
+		if(!isxdigit((unsigned char)*p)) return -1;
+
+		int v = isdigit((unsigned char)*p) ? *p - '0' : tolower((unsigned char)*p) - 'a' + 10;
+		if(high == -1) high = v;
+		else {
+			input[len++] = high << 4 | v;
+			high = -1;
 		}
+	}
+	return high == -1 ? len : -1;
+}
 
-		if(callback) callback(buf, c);
+// func to draw the line of the hex view starting at off as offset, hex and ascii columns
+void editorHexDrawLine(struct append_buffer* ab, size_t off){
+	const char* digits = "0123456789abcdef";
+	char line[96];
+	int len = snprintf(line, sizeof(line), "%08zx  ", off);
+	int n = pager.size - off < YETI_HEX_WIDTH ? (int)(pager.size - off) : YETI_HEX_WIDTH;
+
+	for(int j = 0; j < YETI_HEX_WIDTH; j++){
+		if(j == YETI_HEX_WIDTH / 2) line[len++] = ' ';
+		unsigned char c = pager.map[off + j];
+		line[len++] = j < n ? digits[c >> 4] : ' ';
+		line[len++] = j < n ? digits[c & 15] : ' ';
+		line[len++] = ' ';
+	}
+	line[len++] = ' ';
+	line[len++] = '|';
+	for(int j = 0; j < n; j++){
+		unsigned char c = pager.map[off + j];
+		line[len++] = c >= 32 && c < 127 ? c : '.';
 	}
+	line[len++] = '|';
+
+	appBuffAppend(ab, line, len < wl.screencols ? len : wl.screencols);
+	appBuffAppend(ab, "\x1b[K", 3);
 }
 
-//handles movement of cursor in the editor
-void editorMoveCursor(int key){
-	// handles horizontal movement of the cursor on a line
-	erow* curr_row = (state.cy >= state.textrows) ? NULL : &state.row[state.cy];  
+// func to get the screen column of the cursor in the hex view
+int editorHexCursorCol(){
+	int j = pager.cursor % YETI_HEX_WIDTH;
+	return 10 + j * 3 + (j >= YETI_HEX_WIDTH / 2) + pager.nibble;
+}
 
-	// switch case to change the global state of the cursor
-	switch(key){
-		case ARROW_LEFT:
-			if(state.cy != 0 && state.cx == state.linenooff){
-				state.cy--;
-				state.cx = state.row[state.cy].size + state.linenooff; 
-			} else if(state.cx > state.linenooff) state.cx--;
-			break;
-		case ARROW_RIGHT:
-			if(curr_row && state.cx == curr_row->size + state.linenooff && state.cy < state.textrows-1){
-				state.cy++;
-				state.cx = state.linenooff;
-			} else if(curr_row && state.cx < curr_row->size + state.linenooff) state.cx++;
-			break;
-		case ARROW_UP:
-			if(state.cy != 0) state.cy--;
-			break;
-		case ARROW_DOWN:
-			if(state.cy < state.textrows-1) state.cy++;
-			break;
+// func to overwrite a nibble of the byte under the cursor and move to the next one, the page is marked so it is written back on save
+void editorHexPutNibble(int v){
+	if(pager.size == 0) return;
+
+	unsigned char* c = (unsigned char*)&pager.map[pager.cursor];
+	*c = pager.nibble ? (*c & 0xF0) | v : (*c & 0x0F) | v << 4;
 
+	size_t page = pager.cursor / sysconf(_SC_PAGESIZE);
+	if(!(pager.dirty[page / 8] & 1 << page % 8)){
+		pager.dirty[page / 8] |= 1 << page % 8;
+		pager.dirtypages++;
 	}
-	
-	erow* row = state.cy < state.textrows ? &state.row[state.cy] : NULL;
-	if(row && state.cx > row->size + state.linenooff) state.cx = row->size + state.linenooff;
 
+	if(pager.nibble == 0) pager.nibble = 1;
+	else if(pager.cursor + 1 < pager.size){
+		pager.cursor++;
+		pager.nibble = 0;
+	}
+	editorHexScroll();
 }
 
-// func to process keypress
-void editorProcessKeypress(){
-	int c = editorReadKey();
+// func to write the overwritten pages back to the file, only the pages that changed are written, returns -1 on failure
+int editorHexSave(){
+	if(pager.dirtypages == 0){
+		editorSetStatusMessage("No changes to write");
+		return 0;
+	}
+	if(pager.fd == -1){
+		editorSetStatusMessage("Can't save! %s is read only", pager.filename);
+		return -1;
+	}
 
-	switch (c){
-		// search
-		case CTRL_KEY('f'):
-			editorFind();
+	size_t pagesize = sysconf(_SC_PAGESIZE);
+	size_t pages = (pager.size + pagesize - 1) / pagesize;
+	size_t written = 0;
+	for(size_t page = 0; page < pages; page++){
+		if(!(pager.dirty[page / 8] & 1 << page % 8)) continue;
+
+		size_t off = page * pagesize;
+		size_t len = pager.size - off < pagesize ? pager.size - off : pagesize;
+		if(pwrite(pager.fd, pager.map + off, len, off) != (ssize_t)len){
+			editorSetStatusMessage("Can't save! I/O error: %s", strerror(errno));
+			return -1;
+		}
+		pager.dirty[page / 8] &= ~(1 << page % 8);
+		pager.dirtypages--;
+		written += len;
+	}
+
+	editorSetStatusMessage("%zu bytes written to disk", written);
+	return 0;
+}
+
+// func to ask for a pattern to search for, hex bytes in the hex view and text otherwise
+void editorPagerAskSearch(){
+	char* query = editorPrompt(pager.hex ? "Hex search: %s (ESC to cancel)" : "Search: %s (ESC to cancel)", pager.hex ? NULL : &searchhist, NULL, NULL);
+	if(query == NULL) return;
+
+	int len = pager.hex ? editorHexParse(query) : (int)strlen(query);
+	if(len <= 0){
+		editorSetStatusMessage("Not a hex pattern");
+		free(query);
+		return;
+	}
+
+	free(pager.query);
+	pager.query = query;
+	pager.qlen = len;
+	pager.match = (size_t)-1;
+	editorPagerSearch(1);
+}
+
+// func to draw the line starting at off into the append buffer, tabs are expanded and control chars shown as ? so only the visible columns are produced
+void editorPagerDrawLine(struct append_buffer* ab, size_t off, size_t end){
+	int col = 0, last = pager.coloff + state.screencols;
+	for(size_t j = off; j < end && col < last; j++){
+		char c = pager.map[j];
+		if(c == '\t'){
+			do{
+				if(col >= pager.coloff) appBuffAppend(ab, " ", 1);
+			} while(++col % YETI_TAB_STOP != 0 && col < last);
+			continue;
+		}
+		if(c == '\r' && j + 1 == end) break;
+		if(iscntrl((unsigned char)c)) c = '?';
+		if(col >= pager.coloff) appBuffAppend(ab, &c, 1);
+		col++;
+	}
+	appBuffAppend(ab, "\x1b[K", 3);
+}
+
+// func to draw the pager, the lines of the view are found from the top offset each time so nothing is indexed ahead of the screen
+void editorPagerRefresh(){
+	struct append_buffer ab = APPENDBUF_INIT;
+	editorBeginFrame(&ab);
+
+	ewin* w = &wl.wins[0];
+	if(w->lines == NULL){
+		w->lines = calloc(w->rows, sizeof(char*));
+		w->lens = calloc(w->rows, sizeof(int));
+	}
+
+	struct append_buffer line = APPENDBUF_INIT;
+	appBuffAppend(&ab, "\x1b[?25l", 6);
+
+	size_t off = pager.top;
+	for(int y = 0; y < w->rows - 1; y++){
+		line.len = 0;
+		if(pager.hex){
+			if(off < pager.size) editorHexDrawLine(&line, off);
+			else appBuffAppend(&line, "~\x1b[K", 4);
+			off += YETI_HEX_WIDTH;
+		} else if(off < pager.size || (off == 0 && y == 0)){
+			size_t end = editorPagerLineEnd(off);
+			editorPagerDrawLine(&line, off, end);
+			off = end + 1;
+		} else appBuffAppend(&line, "~\x1b[K", 4);
+		editorFlushLine(&ab, &w->lines[y], &w->lens[y], y, 0, &line);
+	}
+
+	// the status bar shows where the view is in the file since the line nos. are never counted
+	line.len = 0;
+	char status[80], rstatus[80];
+	int pct = pager.size ? (int)((double)pager.top * 100 / pager.size) : 100;
+	int len;
+	if(pager.hex) len = snprintf(status, sizeof(status), "%.20s - byte 0x%zx of 0x%zx [hex]%s", pager.filename, pager.cursor, pager.size, pager.dirtypages ? " (modified)" : "");
+	else len = snprintf(status, sizeof(status), "%.20s - byte %zu of %zu [read only]", pager.filename, pager.top, pager.size);
+	int rlen = snprintf(rstatus, sizeof(rstatus), "%d%%", pct);
+	if(len > wl.screencols) len = wl.screencols;
+	appBuffAppend(&line, "\x1b[7m", 4);
+	appBuffAppend(&line, status, len);
+	while(len < wl.screencols){
+		if(wl.screencols - len == rlen){
+			appBuffAppend(&line, rstatus, rlen);
 			break;
+		}
+		appBuffAppend(&line, " ", 1);
+		len++;
+	}
+	appBuffAppend(&line, "\x1b[m", 3);
+	editorFlushLine(&ab, &w->lines[w->rows - 1], &w->lens[w->rows - 1], w->rows - 1, 0, &line);
 
-		// enter key
+	line.len = 0;
+	editorDrawMessageBar(&line);
+	editorFlushLine(&ab, &wl.msgline, &wl.msglen, wl.screenrows - 1, 0, &line);
+	appBuffFree(&line);
+
+	// the cursor is on the nibble being edited in the hex view and rests on the message bar otherwise
+	char buffer[32];
+	if(pager.hex) len = snprintf(buffer, sizeof(buffer), "\x1b[%d;%dH\x1b[?25h", (int)((pager.cursor - pager.top) / YETI_HEX_WIDTH) + 1, editorHexCursorCol() + 1);
+	else len = snprintf(buffer, sizeof(buffer), "\x1b[%d;%dH\x1b[?25h", wl.screenrows, (int)strlen(state.statusmsg) + 1 < wl.screencols ? (int)strlen(state.statusmsg) + 1 : wl.screencols);
+	appBuffAppend(&ab, buffer, len);
+	editorQueueOutput(ab.b, ab.len);
+	appBuffFree(&ab);
+}
+
+// func to handle a key in the pager
+void editorPagerProcessKey(int c){
+	int page = state.screenrows > 1 ? state.screenrows - 1 : 1;
+	switch(c){
+		case 'q':
+		case CTRL_KEY('q'):
+			editorQuit();
+			break;
+		case ARROW_DOWN:
+		case 'j':
 		case '\r':
-			editorInsertNewLine();
+			editorPagerDown(1);
+			break;
+		case ARROW_UP:
+		case 'k':
+			editorPagerUp(1);
+			break;
+		case MOUSE_EVENT:
+			if(mouse.button & 64){
+				if(mouse.button & 1) editorPagerDown(YETI_WHEEL_LINES);
+				else editorPagerUp(YETI_WHEEL_LINES);
+			}
+			break;
+		case PAGE_DOWN:
+		case ' ':
+			editorPagerDown(page);
+			break;
+		case PAGE_UP:
+		case 'b':
+			editorPagerUp(page);
+			break;
+		case ARROW_RIGHT:
+			pager.coloff += YETI_TAB_STOP;
+			break;
+		case ARROW_LEFT:
+			pager.coloff = pager.coloff > YETI_TAB_STOP ? pager.coloff - YETI_TAB_STOP : 0;
 			break;
-
 		case HOME_KEY:
+			pager.top = 0;
+			pager.coloff = 0;
+			break;
 		case END_KEY:
+		case 'G':
+			editorPagerEnd();
 			break;
-
-		// process commands after hitting the esc, semicolon is used as in c it shows a warning if you declare a variable right after the label 
-		case '\x1b': ;
-			// stores the command typed by the user
-			char* command = editorPrompt("COMMAND: %s (ESC = cancel | q = force quit | u = undo)", NULL);
-			
-			// if the user types a command
-			if(command){
-				// force quits
-				if(command[0] == 'q'){
-					editorQuit();
-				}	
-
-				// undo
-				if(command[0] == 'u'){
-					editorUndoState();
-				}
-			}
+		case 'g':
+			editorPagerGoto();
 			break;
-		
-		// quit when changes are saved
+		case '/':
+		case CTRL_KEY('f'):
+			editorPagerAskSearch();
+			break;
+		case 'n':
+			editorPagerSearch(1);
+			break;
+		case 'N':
+			editorPagerSearch(-1);
+			break;
+		case CTRL_KEY('l'):
+			editorInvalidateFrame();
+			break;
+	}
+}
+
+// func to handle a key in the hex view, hex digits overwrite the byte under the cursor
+void editorHexProcessKey(int c){
+	size_t page = (state.screenrows > 1 ? state.screenrows - 1 : 1) * YETI_HEX_WIDTH;
+	if(c < 128 && isxdigit(c)){
+		editorHexPutNibble(isdigit(c) ? c - '0' : tolower(c) - 'a' + 10);
+		return;
+	}
+
+	switch(c){
+		case 'q':
 		case CTRL_KEY('q'):
-			if(state.modified){
-				editorSetStatusMessage("Unsaved file changes! Save and quit or use ESC + q to force quit.");
-				return;
+			if(pager.dirtypages){
+				editorSetStatusMessage("Unsaved changes! Ctrl-S to save or Q to quit without saving");
+				break;
 			}
 			editorQuit();
 			break;
-		
-		// saves changes to the disk
+		case 'Q':
+			editorQuit();
+			break;
 		case CTRL_KEY('s'):
-			editorSave();
+			editorHexSave();
 			break;
-		
-		// delete a character
-		case BACKSPACE:
-		case CTRL_KEY('h'):
-			editorDelChar();
+		case ARROW_LEFT:
+			if(pager.nibble) pager.nibble = 0;
+			else if(pager.cursor > 0) editorHexMoveTo(pager.cursor - 1);
 			break;
-		case DEL_KEY:
-			editorMoveCursor(ARROW_RIGHT);
-			editorDelChar();
+		case ARROW_RIGHT:
+			editorHexMoveTo(pager.cursor + 1);
 			break;
-
-		// moves the cursor
 		case ARROW_UP:
+			if(pager.cursor >= YETI_HEX_WIDTH) editorHexMoveTo(pager.cursor - YETI_HEX_WIDTH);
+			break;
 		case ARROW_DOWN:
-		case ARROW_LEFT:
-		case ARROW_RIGHT:
-			editorMoveCursor(c);
+			if(pager.cursor + YETI_HEX_WIDTH < pager.size) editorHexMoveTo(pager.cursor + YETI_HEX_WIDTH);
+			break;
+		case MOUSE_EVENT:
+			// a wheel step moves the cursor by a few lines
+			if(!(mouse.button & 64)) break;
+			for(int j = 0; j < YETI_WHEEL_LINES; j++) editorHexProcessKey(mouse.button & 1 ? ARROW_DOWN : ARROW_UP);
+			break;
+		case PAGE_UP:
+			editorHexMoveTo(pager.cursor > page ? pager.cursor - page : pager.cursor % YETI_HEX_WIDTH);
+			break;
+		case PAGE_DOWN:
+			if(pager.cursor + page < pager.size) editorHexMoveTo(pager.cursor + page);
+			else editorHexMoveTo(pager.size);
+			break;
+		case HOME_KEY:
+			editorHexMoveTo(pager.cursor - pager.cursor % YETI_HEX_WIDTH);
+			break;
+		case END_KEY:
+			editorHexMoveTo(pager.cursor - pager.cursor % YETI_HEX_WIDTH + YETI_HEX_WIDTH - 1);
+			break;
+		case 'g':
+			editorPagerGoto();
+			break;
+		case 'G':
+			editorHexMoveTo(pager.size);
+			break;
+		case '/':
+		case CTRL_KEY('f'):
+			editorPagerAskSearch();
+			break;
+		case 'n':
+			editorPagerSearch(1);
+			break;
+		case 'N':
+			editorPagerSearch(-1);
 			break;
-		
 		case CTRL_KEY('l'):
-
-		// add characters 
-		default:
-			editorInsertChar(c);
+			editorInvalidateFrame();
 			break;
 	}
 }
 
-/***INIT***/
+// func to map a file for the pager, the hex view maps it writable and keeps it open to write the changed pages back, returns -1 if it could not be opened
+int editorPagerOpen(const char* filename, int hex){
+	// a file that cannot be written is still shown
+	int fd = hex ? open(filename, O_RDWR) : -1;
+	int writable = fd != -1;
+	if(fd == -1) fd = open(filename, O_RDONLY);
+	if(fd == -1) return -1;
 
-// initializes the state of the editor
-void initEditor(){
-	// initial cursor position
-	state.cx = 0;
-	state.cy = 0;
-	state.rx = 0;
-	
-	// initial no of rows containing text
-	state.textrows = 0;
+	struct stat st;
+	if(fstat(fd, &st) == -1){
+		close(fd);
+		return -1;
+	}
 
-	// initial text
-	state.row = NULL;
+	// only regular files can be mapped
+	if(!S_ISREG(st.st_mode)){
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
 
-	// intial topmost row present on the visible screen
-	state.rowoff = 0;
+	// an empty file cannot be mapped and has nothing to show anyway, the changes made to a private mapping stay in memory until they are written back
+	pager.size = st.st_size;
+	if(pager.size){
+		pager.map = mmap(NULL, pager.size, hex ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+		if(pager.map == MAP_FAILED){
+			close(fd);
+			return -1;
+		}
+	} else pager.map = calloc(1, 1);
 
-	// initial leftmost col visible on the scrrrn
-	state.coloff = 0;
+	if(writable) pager.fd = fd;
+	else {
+		pager.fd = -1;
+		close(fd);
+	}
 
-	// initially no status message
-	state.statusmsg[0] = '\0';
-	
-	// initial timestamp of set status message
-	state.statusmsg_time = 0;
+	size_t pagesize = sysconf(_SC_PAGESIZE);
+	pager.dirty = hex ? calloc((pager.size + pagesize - 1) / pagesize / 8 + 1, 1) : NULL;
+	pager.dirtypages = 0;
+	pager.hex = hex;
+	pager.filename = strdup(filename);
+	pager.top = 0;
+	pager.coloff = 0;
+	pager.cursor = 0;
+	pager.nibble = 0;
+	pager.query = NULL;
+	pager.qlen = 0;
+	pager.match = (size_t)-1;
+	pagermode = 1;
+	return 0;
+}
 
-	// initial modified value
-	state.modified = 0;
-	
-	// iniial lineno offset value
-	state.linenooff = 0;
+// func to check whether a file looks binary, which is when its first block holds a nul byte
+int editorIsBinary(const char* filename){
+	int fd = open(filename, O_RDONLY);
+	if(fd == -1) return 0;
 
-	// initial undo-redo value
-	ur.states = NULL;
+	// a compressed file is opened as the text inside it
+	if(editorDetectCompression(fd) != COMPRESS_NONE){
+		close(fd);
+		return 0;
+	}
 
-	// assign the clone function to the undo-redo variable
-	ur.clone = cloneState;
-	
-	// initial state index in the undo functionalitya
-	ur.size = 0;
-	ur.currStateIndex = 0;
+	char block[8192];
+	ssize_t n = read(fd, block, sizeof(block));
+	close(fd);
+	return n > 0 && memchr(block, '\0', n) != NULL;
+}
 
-	// sets the screen size of the editor
-	if(getWindowSize(&state.screenrows,  &state.screencols) == -1) die("getWindowSize");
-	
-	// leave the 2 lines to display status bar and the status message
-	state.screenrows -= 2;
+// func to run the pager on a file until it is quit
+void editorRunPager(const char* filename, int hex){
+	if(editorPagerOpen(filename, hex) == -1){
+		perror(filename);
+		exit(1);
+	}
+
+	enableRawMode();
+	initEditor();
+	if(hex) editorSetStatusMessage("HELP: 0-f = overwrite | Ctrl-S = save | q = quit | / = hex search | g = goto offset");
+	else editorSetStatusMessage("HELP: q = quit | / = search | n/N = next/prev | g = goto offset");
+	while(1){
+		editorRefreshScreen();
+		if(hex) editorHexProcessKey(editorReadKey());
+		else editorPagerProcessKey(editorReadKey());
+	}
+}
+
+/***INIT***/
+
+// initializes the state of the editor
+void initEditor(){
+	// the editor starts with a single empty buffer
+	bl.buffers = malloc(sizeof(ebuf));
+	bl.size = 1;
+	bl.curr = 0;
+	editorInitBuffer();
+
+	// no clients until a server accepts some
+	cl.clients = NULL;
+	cl.size = 0;
+	cl.curr = -1;
+
+	// sets the screen size of the editor, batch mode and the server have no terminal so they just assume one
+	int rows = 24, cols = 80;
+	if(!batchmode && !servermode && getWindowSize(&rows, &cols) == -1) die("getWindowSize");
+
+	// a single window covers the screen, leaving the 2 lines to display status bar and the status message
+	editorInitWindows(rows, cols, STDIN_FILENO, STDOUT_FILENO);
+
+	// a terminal that stops reading must not stall the editor, what it does not take is queued till it drains
+	if(!batchmode && !servermode){
+		outflags = fcntl(STDOUT_FILENO, F_GETFL);
+		fcntl(STDOUT_FILENO, F_SETFL, outflags | O_NONBLOCK);
+	}
 }
 
 int main(int argc, char *argv[]){
+	// a server holds the buffers for the clients that connect to its socket
+	if(argc >= 2 && strcmp(argv[1], "--server") == 0){
+		if(argc < 3){
+			fprintf(stderr, "Usage: %s --server socket [files...]\n", argv[0]);
+			return 2;
+		}
+		servermode = 1;
+		initEditor();
+		for(int j = 3; j < argc; j++){
+			if(editorOpen(argv[j]) == -1) fprintf(stderr, "%s\n", state.statusmsg);
+		}
+
+		// like the other modes the editor always holds at least one row, even with no files
+		if(state.textrows == 0){
+			editorInsertRow(0, "", 0);
+			editorMarkSaved();
+		}
+		return editorRunServer(argv[2]);
+	}
+
+	// a client only relays the terminal to and from a server
+	if(argc >= 2 && strcmp(argv[1], "--client") == 0){
+		if(argc < 3){
+			fprintf(stderr, "Usage: %s --client socket [file]\n", argv[0]);
+			return 2;
+		}
+		return editorRunClient(argv[2], argc >= 4 ? argv[3] : NULL);
+	}
+
+	// batch mode runs a script against the file without touching the terminal
+	if(argc >= 2 && strcmp(argv[1], "--batch") == 0){
+		if(argc < 3){
+			fprintf(stderr, "Usage: %s --batch script [file]\n", argv[0]);
+			return 2;
+		}
+		batchmode = 1;
+		initEditor();
+		if(argc >= 4 && editorOpen(argv[3]) == -1) die("fopen");
+		if(state.textrows == 0){
+			editorInsertRow(state.textrows, "", 0);
+			editorMarkSaved();
+		}
+		return editorRunBatch(argv[2]);
+	}
+
+	// -R or running as yless shows a file read only without loading it
+	const char* base = strrchr(argv[0], '/');
+	int pagerarg = argc >= 2 && strcmp(argv[1], "-R") == 0 ? 2 : 1;
+	if(pagerarg == 2 || strcmp(base ? base + 1 : argv[0], "yless") == 0){
+		if(argc <= pagerarg){
+			fprintf(stderr, "Usage: %s -R file\n", argv[0]);
+			return 2;
+		}
+		editorRunPager(argv[pagerarg], 0);
+	}
+
+	// -x shows a file as hex, which is also how binary files are opened
+	if(argc >= 2 && strcmp(argv[1], "-x") == 0){
+		if(argc < 3){
+			fprintf(stderr, "Usage: %s -x file\n", argv[0]);
+			return 2;
+		}
+		editorRunPager(argv[2], 1);
+	}
+	if(argc >= 2 && editorIsBinary(argv[1])) editorRunPager(argv[1], 1);
+
 	// start the raw mode
 	enableRawMode();
 	
 	// initialize the size of the editor
 	initEditor();
 	
-	// read text from the file if supplied else open an empty editor
-	if(argc >= 2) editorOpen(argv[1]);
+	// -s restores the files of the last session, else the file is read if supplied or an empty editor is opened
+	int session = argc >= 2 && strcmp(argv[1], "-s") == 0;
+	if(session) editorLoadSession();
+	else if(argc >= 2 && editorOpen(argv[1]) == -1) die("fopen");
 	
 	// if an empty file or no file is opened
 	if(state.textrows == 0){
 		editorInsertRow(state.textrows, "", 0);
-		state.modified--;
+		editorMarkSaved();
 		editorAddState();
 	}
 	
-	// sets the initial status message
-	editorSetStatusMessage("HELP: Ctrl-S = save | Ctrl-Q = quit | Ctrl-F = search | ESC = command mode");
+	// sets the initial status message, unless restoring the session or reading the file left one
+	if(!session && state.statusmsg[0] == '\0') editorSetStatusMessage("HELP: Ctrl-S = save | Ctrl-Q = quit | Ctrl-F = search | ESC = command mode");
+
+	// the session is saved now and then from here on
+	editorTimerStart(TIMER_AUTOSAVE, YETI_AUTOSAVE_MS);
 
 	// loop to continuosly capture keystrokes
 	while (1){